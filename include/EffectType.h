@@ -4,9 +4,15 @@
 #include "DaisyDuino.h"
 #include "IEffect.h"
 #include "../lib/SingleEcho/SingleEcho.h"
+#include "../lib/CabSim/CabSim.h"
+#include "../lib/Reverb/Reverb.h"
+#include "../lib/TapLooper/TapLooper.h"
 
-// Effect Objects
-SingleEcho singleEcho;
+// Effect Objects (hot DSP state, placed in DTCM, large buffers live in their .cpp files)
+SingleEcho DTCM_BSS singleEcho;
+CabSim DTCM_BSS cabSim;
+Reverb DTCM_BSS reverb;
+TapLooper DTCM_BSS tapLooper;
 
 /**
  * The rotary encoder is using Gray code, not standard hex.
@@ -16,6 +22,9 @@ SingleEcho singleEcho;
 enum EffectType
 {
     SINGLEECHO = 0,
+    CABSIM = 1,
+    REVERB = 3,
+    TAPLOOPER = 2,
 
     UNSET = 99
 };
@@ -27,6 +36,12 @@ extern IEffect *GetEffectObject(EffectType type)
 {
     switch (type)
     {
+    case CABSIM:
+        return (IEffect *)&cabSim;
+    case REVERB:
+        return (IEffect *)&reverb;
+    case TAPLOOPER:
+        return (IEffect *)&tapLooper;
     case SINGLEECHO:
     case UNSET:
     default:
@@ -4,10 +4,14 @@
 #include "DaisyDuino.h"
 
 #define DEBUG 0
+#define BENCHMARK 0 // Runs the DSP library benchmarks at startup, requires DEBUG
 
 #define BLOCKSIZE 1
 #define DAISY_SAMPLE_RATE AUDIO_SR_96K
 
+// Sample rate in Hz, DAISY_SAMPLE_RATE is the DaisyDuino enum value that selects it, not a frequency
+static constexpr float sampleRateHz = 96000.0f;
+
 #define AUDIO_IN_CH 1
 #define AUDIO_OUT_CH 0
 
@@ -0,0 +1,95 @@
+#include "PitchBenchmark.h"
+
+// Each note is played for this long, the estimate is read at the end
+static const size_t benchNoteSamples = 28800;
+
+// Open strings of a guitar in standard tuning, then the 12th and 24th frets of the high E string
+static const float benchNotes[] = {82.41f, 110.0f, 146.83f, 196.0f, 246.94f, 329.63f, 659.26f, 1318.51f};
+static const size_t benchNoteCount = sizeof(benchNotes) / sizeof(benchNotes[0]);
+
+// Harmonic levels of the plucked note, a weak fundamental is the hard case for autocorrelation methods
+static const float benchHarmonics[] = {0.4f, 1.0f, 0.6f, 0.3f, 0.2f};
+static const size_t benchHarmonicCount = sizeof(benchHarmonics) / sizeof(benchHarmonics[0]);
+
+static PitchTracker benchTracker;
+
+// Plucked note with a decaying harmonic series, harmonics above the tracker's band are left out
+static float PluckedNote(float freq, size_t sample)
+{
+    float t = (float)sample / sampleRateHz;
+    float out = 0.0f;
+    for (size_t h = 0; h < benchHarmonicCount; h++)
+    {
+        float harmonicFreq = freq * (float)(h + 1);
+        if (harmonicFreq < 5000.0f)
+        {
+            out += benchHarmonics[h] * sinf(2.0f * PI_VAL * harmonicFreq * t);
+        }
+    }
+    return 0.3f * expf(-1.5f * t) * out;
+}
+
+// Feeds a signal to the tracker and prints what it settled on
+template <typename Signal>
+static void RunSignal(const char *name, float expected, Signal signal, CycleCounter &counter)
+{
+    benchTracker.Reset();
+    for (size_t i = 0; i < benchNoteSamples; i++)
+    {
+        float in = signal(i);
+
+        counter.Start();
+        benchTracker.Process(in);
+        counter.Stop(1);
+    }
+
+    PitchEstimate estimate;
+    benchTracker.Read(estimate);
+
+    debugPrint(name);
+    debugPrint(": ");
+    debugPrintF(estimate.frequency, 2);
+    debugPrint(" Hz, clarity ");
+    debugPrintF(estimate.clarity, 3);
+    if (expected > 0.0f && estimate.frequency > 0.0f)
+    {
+        debugPrint(", error ");
+        debugPrintF(1200.0f * log2f(estimate.frequency / expected), 2);
+        debugPrintln(" cents");
+    }
+    else
+    {
+        debugPrintln((expected > 0.0f) ? ", MISSED" : ((estimate.frequency > 0.0f) ? ", FALSE DETECTION" : ", unvoiced"));
+    }
+}
+
+void RunPitchBenchmark()
+{
+    CycleCounter counter;
+
+    debugPrintln("Pitch benchmark:");
+
+    benchTracker.Init(sampleRateHz);
+
+    for (size_t n = 0; n < benchNoteCount; n++)
+    {
+        float freq = benchNotes[n];
+        char name[16];
+        snprintf(name, sizeof(name), "%.2f Hz", freq);
+        RunSignal(name, freq, [freq](size_t i) { return PluckedNote(freq, i); }, counter);
+    }
+
+    // White noise has no pitch and should stay unvoiced
+    uint32_t noiseState = 1;
+    RunSignal("Noise", 0.0f, [&noiseState](size_t) {
+        noiseState = (noiseState * 1664525u) + 1013904223u;
+        return 0.1f * (((float)(noiseState >> 8) * (2.0f / 16777216.0f)) - 1.0f);
+    }, counter);
+
+    debugPrint("Cost: ");
+    debugPrintF(counter.CyclesPerSample(), 1);
+    debugPrint(" cycles/sample, worst ");
+    debugPrint(counter.MaxCycles());
+    debugPrint(" cycles, overruns ");
+    debugPrintln(benchTracker.GetOverruns());
+}
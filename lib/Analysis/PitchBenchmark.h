@@ -0,0 +1,15 @@
+#ifndef PITCH_BENCHMARK_H
+#define PITCH_BENCHMARK_H
+
+#include "DaisyDuino.h"
+#include "../../include/PedalConfig.h"
+#include "../Utility/CycleCounter.h"
+#include "PitchTracker.h"
+
+/**
+ * Runs synthetic guitar notes across the neck, and noise, through the pitch tracker and prints
+ * the detected pitch, its error in cents, the clarity and the cost in cycles per sample
+ */
+void RunPitchBenchmark();
+
+#endif
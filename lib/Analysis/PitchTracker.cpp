@@ -0,0 +1,376 @@
+#include "PitchTracker.h"
+
+// Cutoff of the decimation filter, well under the 6kHz Nyquist frequency of the decimated stream
+static const float pitchDecimationCutoff = 3000.0f;
+
+// Section Qs of a 4th order Butterworth filter
+static const float pitchButterworthQ1 = 0.5412f;
+static const float pitchButterworthQ2 = 1.3066f;
+
+// Cutoff of the DC blocker, well under the lowest fundamental
+static const float pitchDcBlockCutoff = 20.0f;
+
+void PitchTracker::Init(float pSampleRate)
+{
+    decimatedRate = pSampleRate / (float)pitchDecimation;
+    minLag = (size_t)(decimatedRate / pitchMaxFrequency);
+
+    decimationFilter.Init(pSampleRate);
+    decimationFilter.Section(0).SetLowpass(pitchDecimationCutoff, pitchButterworthQ1);
+    decimationFilter.Section(1).SetLowpass(pitchDecimationCutoff, pitchButterworthQ2);
+    dcBlocker.Init(decimatedRate);
+    dcBlocker.SetFrequency(pitchDcBlockCutoff);
+
+    fft.Init();
+
+    // Copy, both transforms, the power spectrum, the NSDF and the peak search (a lag per unit, then the pick), spread over one hop
+    size_t totalUnits = pitchFftSize + (RealFft<pitchFftSize>::WorkUnits() * 2) + (pitchFftSize / 2) + ((pitchMaxLag + 2) * 2);
+    size_t hopSamples = pitchHopSize * pitchDecimation;
+    unitsPerSample = (totalUnits + hopSamples - 1) / hopSamples;
+
+    sequence = 0;
+    publishedFrequency = 0.0f;
+    publishedClarity = 0.0f;
+    publishedLevel = 0.0f;
+    publishedCount = 0;
+    lastReadCount = 0;
+
+    Reset();
+}
+
+void PitchTracker::Reset()
+{
+    decimationFilter.Reset();
+    decimationCount = 0;
+    dcBlocker.Reset();
+
+    for (size_t i = 0; i < historySize; i++)
+    {
+        history[i] = 0.0f;
+    }
+    historyPos = 0;
+    hopCount = 0;
+
+    jobPhase = JOB_IDLE;
+    overruns = 0;
+}
+
+ITCM_FUNC void PitchTracker::Process(float in)
+{
+    float filtered = decimationFilter.Process(in);
+
+    // Keep every pitchDecimation-th sample of the filtered input
+    decimationCount++;
+    if (decimationCount == pitchDecimation)
+    {
+        decimationCount = 0;
+
+        history[historyPos] = dcBlocker.ProcessHighpass(filtered);
+        historyPos = (historyPos + 1 == historySize) ? 0 : (historyPos + 1);
+
+        hopCount++;
+        if (hopCount == pitchHopSize)
+        {
+            hopCount = 0;
+            StartAnalysis();
+        }
+    }
+
+    RunJob(unitsPerSample);
+}
+
+bool PitchTracker::Read(PitchEstimate &estimate)
+{
+    // Retry if the audio callback published in the middle of the copy
+    uint32_t before;
+    uint32_t after;
+    do
+    {
+        before = sequence;
+        estimate.frequency = publishedFrequency;
+        estimate.clarity = publishedClarity;
+        estimate.level = publishedLevel;
+        estimate.count = publishedCount;
+        after = sequence;
+    } while ((before & 1) != 0 || before != after);
+
+    bool fresh = (estimate.count != lastReadCount);
+    lastReadCount = estimate.count;
+    return fresh;
+}
+
+size_t PitchTracker::GetOverruns()
+{
+    return overruns;
+}
+
+// Starts the analysis of the window that just filled
+void PitchTracker::StartAnalysis()
+{
+    // The previous analysis should be done by now, finish it here if not
+    if (jobPhase != JOB_IDLE)
+    {
+        RunJob(SIZE_MAX);
+        overruns++;
+    }
+
+    // The oldest sample of the window, the hop that follows lands in the spare part of the history
+    windowStart = (historyPos + historySize - pitchWindowSize) % historySize;
+    energy = 0.0f;
+    jobIndex = 0;
+    jobPhase = JOB_COPY;
+}
+
+// Runs up to budget units of the current analysis
+ITCM_FUNC void PitchTracker::RunJob(size_t budget)
+{
+    while (budget > 0 && jobPhase != JOB_IDLE)
+    {
+        switch (jobPhase)
+        {
+        case JOB_COPY:
+            budget = RunCopy(budget);
+            break;
+
+        case JOB_FORWARD:
+            // Whatever the transform leaves over goes to the next phase
+            budget = fft.Step(budget);
+            if (fft.IsDone())
+            {
+                jobPhase = JOB_POWER;
+                jobIndex = 0;
+            }
+            break;
+
+        case JOB_POWER:
+            budget = RunPower(budget);
+            break;
+
+        case JOB_INVERSE:
+            budget = fft.Step(budget);
+            if (fft.IsDone())
+            {
+                jobPhase = JOB_NSDF;
+                jobIndex = 0;
+            }
+            break;
+
+        case JOB_NSDF:
+            budget = RunNsdf(budget);
+            break;
+
+        case JOB_PICK:
+            budget = RunPick(budget);
+            break;
+
+        default:
+            jobPhase = JOB_IDLE;
+            break;
+        }
+    }
+}
+
+// Copies the window into the FFT buffer with zero padding and sums its energy, one sample per unit
+ITCM_FUNC size_t PitchTracker::RunCopy(size_t budget)
+{
+    while (budget > 0 && jobIndex < pitchFftSize)
+    {
+        float x = 0.0f;
+        if (jobIndex < pitchWindowSize)
+        {
+            x = WindowSample(jobIndex);
+            energy += x * x;
+        }
+        fftBuffer[jobIndex] = x;
+
+        jobIndex++;
+        budget--;
+    }
+
+    if (jobIndex == pitchFftSize)
+    {
+        fft.StartForward(fftBuffer);
+        jobPhase = JOB_FORWARD;
+    }
+
+    return budget;
+}
+
+// Replaces the spectrum with its power spectrum, whose inverse is the autocorrelation, one bin per unit
+ITCM_FUNC size_t PitchTracker::RunPower(size_t budget)
+{
+    if (jobIndex == 0 && budget > 0)
+    {
+        // DC and Nyquist are real and share the first slot
+        fftBuffer[0] *= fftBuffer[0];
+        fftBuffer[1] *= fftBuffer[1];
+        jobIndex = 1;
+        budget--;
+    }
+
+    while (budget > 0 && jobIndex < pitchFftSize / 2)
+    {
+        float re = fftBuffer[jobIndex * 2];
+        float im = fftBuffer[(jobIndex * 2) + 1];
+        fftBuffer[jobIndex * 2] = (re * re) + (im * im);
+        fftBuffer[(jobIndex * 2) + 1] = 0.0f;
+
+        jobIndex++;
+        budget--;
+    }
+
+    if (jobIndex == pitchFftSize / 2)
+    {
+        fft.StartInverse(fftBuffer);
+        jobPhase = JOB_INVERSE;
+    }
+
+    return budget;
+}
+
+// Normalizes the autocorrelation into the NSDF, one lag per unit
+ITCM_FUNC size_t PitchTracker::RunNsdf(size_t budget)
+{
+    while (budget > 0 && jobIndex < pitchMaxLag + 2)
+    {
+        size_t lag = jobIndex;
+
+        // m(lag) is the energy of both overlapping parts, each lag drops one sample from either end
+        if (lag == 0)
+        {
+            lagEnergy = 2.0f * energy;
+        }
+        else
+        {
+            float first = WindowSample(lag - 1);
+            float last = WindowSample(pitchWindowSize - lag);
+            lagEnergy -= (first * first) + (last * last);
+        }
+
+        nsdf[lag] = (lagEnergy > 0.0f) ? ((2.0f * fftBuffer[lag]) / lagEnergy) : 0.0f;
+
+        jobIndex++;
+        budget--;
+    }
+
+    if (jobIndex == pitchMaxLag + 2)
+    {
+        keyCount = 0;
+        highestKey = 0.0f;
+        pastZeroLag = false;
+        inLobe = false;
+        lobeLag = 0;
+        jobIndex = 1;
+        jobPhase = JOB_PICK;
+    }
+
+    return budget;
+}
+
+// Collects the key maxima, the highest points of each positive lobe after the first negative crossing,
+// one lag per unit, then picks the period from them in one more unit
+ITCM_FUNC size_t PitchTracker::RunPick(size_t budget)
+{
+    while (budget > 0 && jobIndex <= pitchMaxLag)
+    {
+        size_t lag = jobIndex;
+        float value = nsdf[lag];
+        if (!pastZeroLag)
+        {
+            pastZeroLag = (value < 0.0f);
+        }
+        else if (value > 0.0f)
+        {
+            if (!inLobe || value > nsdf[lobeLag])
+            {
+                lobeLag = lag;
+            }
+            inLobe = true;
+        }
+        else if (inLobe)
+        {
+            inLobe = false;
+            AddKeyMaximum(lobeLag);
+        }
+
+        jobIndex++;
+        budget--;
+    }
+
+    if (jobIndex > pitchMaxLag && budget > 0)
+    {
+        // A lobe still open at the longest lag counts too
+        if (inLobe)
+        {
+            AddKeyMaximum(lobeLag);
+        }
+        PublishPeak();
+        jobPhase = JOB_IDLE;
+        budget--;
+    }
+
+    return budget;
+}
+
+void PitchTracker::AddKeyMaximum(size_t lag)
+{
+    if (lag >= minLag && keyCount < pitchMaxKeyMaxima)
+    {
+        keyLags[keyCount++] = lag;
+        highestKey = (nsdf[lag] > highestKey) ? nsdf[lag] : highestKey;
+    }
+}
+
+// Publishes the period of the first key maximum close to the highest one, later ones are multiples of the period
+void PitchTracker::PublishPeak()
+{
+    float level = sqrtf(energy / (float)pitchWindowSize);
+
+    for (size_t k = 0; k < keyCount; k++)
+    {
+        size_t lag = keyLags[k];
+        if (nsdf[lag] < highestKey * pitchPeakThreshold)
+        {
+            continue;
+        }
+
+        // Parabolic interpolation between the neighbouring lags
+        float left = nsdf[lag - 1];
+        float centre = nsdf[lag];
+        float right = nsdf[lag + 1];
+        float denominator = left - (2.0f * centre) + right;
+        float shift = (denominator < 0.0f) ? (0.5f * (left - right) / denominator) : 0.0f;
+        float clarity = centre - (0.25f * (left - right) * shift);
+
+        if (clarity >= pitchMinClarity && level >= pitchMinLevel)
+        {
+            Publish(decimatedRate / ((float)lag + shift), clarity, level);
+            return;
+        }
+        break;
+    }
+
+    Publish(0.0f, (keyCount > 0) ? highestKey : 0.0f, level);
+}
+
+// Writes a new estimate between two sequence increments, Read() retries while the sequence is odd
+void PitchTracker::Publish(float frequency, float clarity, float level)
+{
+    sequence = sequence + 1;
+    publishedFrequency = frequency;
+    publishedClarity = clarity;
+    publishedLevel = level;
+    publishedCount = publishedCount + 1;
+    sequence = sequence + 1;
+}
+
+// Sample index of the window being analysed
+float PitchTracker::WindowSample(size_t index)
+{
+    size_t position = windowStart + index;
+    if (position >= historySize)
+    {
+        position -= historySize;
+    }
+    return history[position];
+}
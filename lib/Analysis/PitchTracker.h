@@ -0,0 +1,164 @@
+#ifndef PITCH_TRACKER_H
+#define PITCH_TRACKER_H
+
+#include "DaisyDuino.h"
+#include "../../include/PedalConfig.h"
+#include "../Convolution/RealFft.h"
+#include "../Filters/BiquadFilter.h"
+#include "../Filters/OnePoleFilter.h"
+#include "../Utility/MemoryPlacement.h"
+
+// The input is low passed and decimated to 12kHz before the analysis
+static const size_t pitchDecimation = 8;
+
+// Analysis window and hop in decimated samples (85ms windows every 21ms at 12kHz)
+static const size_t pitchWindowSize = 1024;
+static const size_t pitchHopSize = 256;
+
+// Zero padded to twice the window so the FFT autocorrelation does not wrap around
+static const size_t pitchFftSize = pitchWindowSize * 2;
+
+// Range of detectable fundamentals, a drop D guitar up to the 24th fret of the high E string
+static constexpr float pitchMinFrequency = 70.0f;
+static const float pitchMaxFrequency = 1400.0f;
+
+// Longest lag searched, in decimated samples (the period of pitchMinFrequency at the decimated rate, rounded up)
+static const size_t pitchMaxLag = (size_t)(sampleRateHz / (float)pitchDecimation / pitchMinFrequency) + 1;
+
+// Most positive NSDF lobes considered when picking the peak
+static const size_t pitchMaxKeyMaxima = 32;
+
+// The first lobe peak at least this fraction of the highest one is the period
+static const float pitchPeakThreshold = 0.9f;
+
+// Windows below either of these are published as unvoiced
+static const float pitchMinClarity = 0.7f;
+static const float pitchMinLevel = 0.003f;
+
+/**
+ * One published pitch estimate
+ */
+struct PitchEstimate
+{
+    float frequency; // Fundamental in Hz, 0 when nothing is voiced
+    float clarity;   // Height of the chosen NSDF peak, 0 to 1, how periodic the window was
+    float level;     // RMS level of the analysed window
+    uint32_t count;  // Number of analyses published so far
+};
+
+/**
+ * Pitch detection service using the McLeod Pitch Method on a decimated copy of the input
+ *
+ * The audio callback feeds every input sample to Process(). Every pitchHopSize decimated samples the
+ * latest window is analysed: its autocorrelation is computed with a zero padded FFT, turned into the
+ * normalized square difference function (NSDF), and the first NSDF peak within pitchPeakThreshold of
+ * the highest one gives the period, refined by parabolic interpolation.
+ *
+ * Like PartitionedConvolver, the analysis of one hop is sliced into work units and spread over the
+ * samples of the next hop, so the cost per sample is flat. Results are published through a seqlock,
+ * Read() from Loop() always returns a complete estimate even if the audio interrupt publishes mid-read.
+ *
+ * Latency from a note to its estimate is one window plus up to two hops (about 130ms).
+ */
+class PitchTracker
+{
+public:
+    /**
+     * Initialize the tracker with nothing published
+     * @param pSampleRate Sample rate of the input, the lag range is sized for sampleRateHz
+     */
+    void Init(float pSampleRate);
+
+    /**
+     * Clears the input history and stops the analysis in progress, the last estimate stays published
+     */
+    void Reset();
+
+    /**
+     * Feeds one input sample, audio callback only
+     */
+    void Process(float in);
+
+    /**
+     * Copies the latest estimate, safe to call from Loop() while the audio callback runs
+     * @return True if the estimate is newer than the one returned by the previous call
+     */
+    bool Read(PitchEstimate &estimate);
+
+    /**
+     * @return Number of analyses that did not finish within their hop and were completed on the hop boundary
+     */
+    size_t GetOverruns();
+
+private:
+    enum JobPhase
+    {
+        JOB_COPY,
+        JOB_FORWARD,
+        JOB_POWER,
+        JOB_INVERSE,
+        JOB_NSDF,
+        JOB_PICK,
+        JOB_IDLE
+    };
+
+    void StartAnalysis();
+    void RunJob(size_t budget);
+    size_t RunCopy(size_t budget);
+    size_t RunPower(size_t budget);
+    size_t RunNsdf(size_t budget);
+    size_t RunPick(size_t budget);
+    void AddKeyMaximum(size_t lag);
+    void PublishPeak();
+    void Publish(float frequency, float clarity, float level);
+    float WindowSample(size_t index);
+
+    float decimatedRate;
+    size_t minLag;
+
+    // Anti-aliasing filter ahead of the decimation, a 4th order Butterworth lowpass
+    BiquadFilterCascade<2> decimationFilter;
+    size_t decimationCount;
+
+    // Removes DC from the decimated stream, an offset keeps the NSDF from going negative and hides every peak
+    OnePoleFilter dcBlocker;
+
+    // Decimated history, one window plus the hop that arrives while the window is analysed
+    static const size_t historySize = pitchWindowSize + pitchHopSize;
+    float history[historySize];
+    size_t historyPos;
+    size_t hopCount;
+
+    // Analysis job
+    RealFft<pitchFftSize> fft;
+    float fftBuffer[pitchFftSize];
+    float nsdf[pitchMaxLag + 2];
+    JobPhase jobPhase;
+    size_t jobIndex;
+    size_t windowStart;
+    float energy;
+    float lagEnergy;
+
+    // Peak search, the key maxima found so far and the lobe being scanned
+    size_t keyLags[pitchMaxKeyMaxima];
+    size_t keyCount;
+    float highestKey;
+    bool pastZeroLag;
+    bool inLobe;
+    size_t lobeLag;
+
+    size_t unitsPerSample;
+    size_t overruns;
+
+    // Seqlock, odd while the audio callback is writing the estimate
+    volatile uint32_t sequence;
+    volatile float publishedFrequency;
+    volatile float publishedClarity;
+    volatile float publishedLevel;
+    volatile uint32_t publishedCount;
+
+    // Reader side, Loop() only
+    uint32_t lastReadCount;
+};
+
+#endif
@@ -0,0 +1,245 @@
+#include "CabSim.h"
+
+// CABINET NOTES:
+//  - The built in cabinets are generated at load time by running an impulse through a
+//    filter cascade (low cut, low resonance, presence, high cut) and fading out the tail
+//  - Measured impulse responses can be loaded with LoadImpulseResponse, anything past
+//    cabIrLength taps is truncated
+//  - Convolution latency is 2 * cabPartitionSize samples (~1.3ms at 96kHz)
+//  - Loading an impulse response crossfades through the dry signal: the cabinet fades out, the
+//    new one is loaded and fed the length of the impulse response of input, then fades in
+
+// Convolution, in DTCM with the TCM layout, kept out of AXI SRAM otherwise
+static PartitionedConvolver<cabPartitionSize, cabMaxPartitions> DTCM_OR_SDRAM_BSS convolver;
+
+// Time domain IR, only used while loading so it lives in SDRAM
+static float DSY_SDRAM_BSS irBuffer[cabIrLength];
+
+// Initialize the cabinet simulator
+void CabSim::Setup(size_t pNumChannels)
+{
+    // Initialize the convolver
+    convolver.Init();
+
+    // Initialize the level
+    level.Init(cabLevelKnobPin, INPUT, levelValue, minCabLevelValue, maxCabLevelValue);
+
+    // Initialize the mix
+    mix.Init(cabMixKnobPin, INPUT, mixValue, minCabMixValue, maxCabMixValue);
+
+    // Initialize the cabinet switcher pins
+    cabSwitcher.Init(cabSwitcherPin1, INPUT, cabSwitcherPin2, INPUT);
+    pinMode(openBackLedPin, OUTPUT);
+    pinMode(closedBackLedPin, OUTPUT);
+    pinMode(brightLedPin, OUTPUT);
+
+    // Load the selected cabinet
+    currentCabType = CT_UNSET;
+    CabSwitcherLoopControl();
+}
+
+// Clean up the cabinet simulator
+void CabSim::Cleanup()
+{
+    // Stop the callback from using the convolver while it is cleared
+    __disable_irq();
+    convolverIdle = true;
+    __enable_irq();
+    convolver.Reset();
+
+    // Turn off the LEDs
+    analogWrite(openBackLedPin, 0);
+    analogWrite(closedBackLedPin, 0);
+    analogWrite(brightLedPin, 0);
+}
+
+// Audio callback when audio input occurs
+ITCM_FUNC void CabSim::AudioCallback(float **in, float **out, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        float dry = in[AUDIO_IN_CH][i];
+
+        // Pass the dry signal through while an impulse response is loading
+        if (convolverIdle)
+        {
+            out[AUDIO_OUT_CH][i] = dry;
+            continue;
+        }
+
+        // Convolve with the cabinet
+        float wet = convolver.Process(dry);
+
+        // Mix Dry and Wet
+        float mixed = ((wet * mixValue) + (dry * (1.0f - mixValue))) * levelValue;
+
+        // Crossfade to the dry signal before a load and back after it, so neither switch clicks.
+        // A new impulse response only fades in once the convolver has been fed enough input to fill it,
+        // otherwise the start of its output would be a gated step
+        if (irLoadRequested)
+        {
+            irFade -= 1.0f / (float)cabLoadFadeLength;
+            if (irFade <= 0.0f)
+            {
+                irFade = 0.0f;
+                convolverIdle = true;
+            }
+        }
+        else if (irWarmup > 0)
+        {
+            irWarmup--;
+        }
+        else if (irFade < 1.0f)
+        {
+            irFade = fminf(irFade + (1.0f / (float)cabLoadFadeLength), 1.0f);
+        }
+
+        // Send to I/O
+        out[AUDIO_OUT_CH][i] = dry + ((mixed - dry) * irFade);
+    }
+}
+
+// Logic for the cabinet simulator to add into the main loop
+void CabSim::Loop()
+{
+    // Update the level if the knob has been moved
+    if (level.SetNewValue(levelValue))
+    {
+        debugPrint("Updated the level to: ");
+        debugPrintln(levelValue);
+    }
+
+    // Update the mix if the knob has been moved
+    if (mix.SetNewValue(mixValue))
+    {
+        debugPrint("Updated the mix to: ");
+        debugPrintln(mixValue);
+    }
+
+    // Handle cabinet type
+    CabSwitcherLoopControl();
+}
+
+// Return the effect name (for debugging)
+String CabSim::GetEffectName()
+{
+    return "CabSim";
+}
+
+// Load an external impulse response
+void CabSim::LoadImpulseResponse(const float *ir, size_t length)
+{
+    FadeOutConvolver();
+    LoadConvolver(ir, length);
+}
+
+// Ask the audio callback to fade the cabinet out and wait until it has stopped using the convolver
+void CabSim::FadeOutConvolver()
+{
+    irLoadRequested = true;
+
+    unsigned long fadeStart = millis();
+    while (!convolverIdle && (millis() - fadeStart < cabLoadFadeTimeout))
+    {
+    }
+}
+
+// Load an impulse response into the convolver and fade it back in
+void CabSim::LoadConvolver(const float *ir, size_t length)
+{
+    // The load shares the FFT with Process(), so the callback must not use the convolver until it is done.
+    // Masking interrupts also orders these flags with the convolver writes, the compiler cannot move
+    // memory accesses across __disable_irq() or __enable_irq()
+    __disable_irq();
+    convolverIdle = true;
+    irFade = 0.0f;
+    irWarmup = convolver.GetLatency() + ((length < cabIrLength) ? length : cabIrLength);
+    __enable_irq();
+
+    convolver.LoadImpulseResponse(ir, length);
+
+    __disable_irq();
+    irLoadRequested = false;
+    convolverIdle = false;
+    __enable_irq();
+}
+
+// Handle reading the SPDT switch and setting the cabinet type
+void CabSim::CabSwitcherLoopControl()
+{
+    // Determine which cabinet is selected
+    uint8_t position = cabSwitcher.ReadToggle();
+    CabType selected = (position == 0) ? OPEN_BACK : ((position == 2) ? BRIGHT : CLOSED_BACK);
+
+    // Only load the cabinet if we have a new one
+    if (selected != currentCabType)
+    {
+        SetCabType(selected);
+    }
+}
+
+// Load the impulse response for a cabinet type and update the LEDs
+void CabSim::SetCabType(CabType type)
+{
+    debugPrint("Changing to cabinet: ");
+    debugPrintln(type);
+
+    GenerateImpulseResponse(type);
+
+    // Fade out the cabinet that is playing, there is none yet when the effect starts
+    if (currentCabType != CT_UNSET)
+    {
+        FadeOutConvolver();
+    }
+    currentCabType = type;
+    LoadConvolver(irBuffer, cabIrLength);
+
+    // Turn on only the LED of the selected cabinet
+    analogWrite(openBackLedPin, (type == OPEN_BACK) ? cabLedIntensity : 0);
+    analogWrite(closedBackLedPin, (type == CLOSED_BACK) ? cabLedIntensity : 0);
+    analogWrite(brightLedPin, (type == BRIGHT) ? cabLedIntensity : 0);
+}
+
+// Fill the IR buffer with the impulse response of a cabinet voicing
+void CabSim::GenerateImpulseResponse(CabType type)
+{
+    BiquadFilterCascade<4> voicing;
+    voicing.Init(sampleRateHz);
+
+    switch (type)
+    {
+    case CLOSED_BACK:
+        voicing.Section(0).SetHighpass(60.0f, 0.707f);
+        voicing.Section(1).SetPeak(100.0f, 1.2f, 5.0f);
+        voicing.Section(2).SetPeak(1800.0f, 1.5f, 3.0f);
+        voicing.Section(3).SetLowpass(4200.0f, 0.9f);
+        break;
+
+    case BRIGHT:
+        voicing.Section(0).SetHighpass(90.0f, 0.707f);
+        voicing.Section(1).SetPeak(800.0f, 1.0f, -3.0f);
+        voicing.Section(2).SetPeak(3500.0f, 1.5f, 5.0f);
+        voicing.Section(3).SetLowpass(7000.0f, 0.8f);
+        break;
+
+    case OPEN_BACK:
+    default:
+        voicing.Section(0).SetHighpass(70.0f, 0.707f);
+        voicing.Section(1).SetPeak(110.0f, 1.0f, 3.0f);
+        voicing.Section(2).SetPeak(2500.0f, 1.5f, 4.0f);
+        voicing.Section(3).SetLowpass(5500.0f, 0.707f);
+        break;
+    }
+
+    // Run an impulse through the filters
+    for (size_t i = 0; i < cabIrLength; i++)
+    {
+        irBuffer[i] = voicing.Process((i == 0) ? 1.0f : 0.0f);
+    }
+
+    // Fade out the tail so the truncation does not click
+    for (size_t i = 0; i < cabIrFadeLength; i++)
+    {
+        irBuffer[cabIrLength - 1 - i] *= (float)i / (float)cabIrFadeLength;
+    }
+}
@@ -0,0 +1,113 @@
+#ifndef CAB_SIM_H
+#define CAB_SIM_H
+
+#include "DaisyDuino.h"
+#include "../../include/IEffect.h"
+#include "../../include/PedalConfig.h"
+#include "../Inputs/NFNToggle.h"
+#include "../Inputs/Knob.h"
+#include "../Filters/BiquadFilter.h"
+#include "../Convolution/PartitionedConvolver.h"
+#include "../Utility/MemoryPlacement.h"
+
+/**********************************************
+ * Cabinet Simulator Effect
+ * 
+ * SPST 1 - N/U
+ * SPST 2 - N/U
+ * SPST 3 - N/U
+ * SPST 4 - N/U
+ * 
+ * SPDT 1 - Cabinet Switcher
+ * SPDT 2 - N/U
+ * 
+ * Knob 1 - Output Level
+ * Knob 2 - Mix
+ * Knob 3 - N/U
+ * Knob 4 - N/U
+ * 
+ * LED 1 - Open Back 1x12
+ * LED 2 - Closed Back 4x12
+ * LED 3 - Bright 2x12
+ * LED 4 - N/U
+ **********************************************/
+
+// Pin renaming
+static const int cabLevelKnobPin = effectPotPin4;
+static const int cabMixKnobPin = effectPotPin2;
+static const int cabSwitcherPin1 = effectSPDT2Pin1;
+static const int cabSwitcherPin2 = effectSPDT2Pin2;
+static const int openBackLedPin = effectLedPin1;
+static const int closedBackLedPin = effectLedPin2;
+static const int brightLedPin = effectLedPin3;
+
+// Convolution constants, 64 partitions of 64 taps gives a 4096 tap (~43ms) impulse response
+static const size_t cabPartitionSize = 64;
+static const size_t cabMaxPartitions = 64;
+static const size_t cabIrLength = cabPartitionSize * cabMaxPartitions;
+static const size_t cabIrFadeLength = 512;
+static const size_t cabLedIntensity = 128;
+
+// Crossfade between the cabinet and the dry signal around an impulse response load, 5ms each way
+// The wait for the fade out (in ms) only runs out when audio is not running
+static const size_t cabLoadFadeLength = (size_t)(0.005f * sampleRateHz);
+static const unsigned long cabLoadFadeTimeout = 20;
+
+// Level constants
+static const float minCabLevelValue = 1.0f;
+static const float maxCabLevelValue = 0.0f;
+
+// Mix constants
+static const float minCabMixValue = 1.0f;
+static const float maxCabMixValue = 0.0f;
+
+// Cabinet constants
+enum CabType
+{
+    OPEN_BACK = 0,
+    CLOSED_BACK = 1,
+    BRIGHT = 2,
+
+    CT_UNSET = 99
+};
+
+class CabSim : public IEffect
+{
+public:
+    void Setup(size_t pNumChannels);
+    void Cleanup();
+    void AudioCallback(float **in, float **out, size_t size);
+    void Loop();
+    String GetEffectName();
+
+    /**
+     * Loads an external impulse response (e.g. a measured cabinet) in place of the built in ones
+     */
+    void LoadImpulseResponse(const float *ir, size_t length);
+
+private:
+    void CabSwitcherLoopControl();
+    void SetCabType(CabType type);
+    void GenerateImpulseResponse(CabType type);
+    void FadeOutConvolver();
+    void LoadConvolver(const float *ir, size_t length);
+
+    // Input handlers
+    NFNToggle cabSwitcher;
+    Knob level;
+    Knob mix;
+
+    // Mutable parameters
+    float levelValue = 1.0f;
+    float mixValue = 1.0f;
+    CabType currentCabType = CT_UNSET;
+
+    // Impulse response loading, the callback fades the cabinet out on request and then stops using the
+    // convolver, passing the dry signal through until the new impulse response is in and it can fade back in
+    volatile bool irLoadRequested = false;
+    volatile bool convolverIdle = false;
+    float irFade = 0.0f;
+    size_t irWarmup = 0;
+};
+
+#endif
@@ -0,0 +1,104 @@
+#include "ConvolutionBenchmark.h"
+
+static const size_t benchMaxIrLength = 4096;
+static const size_t benchSamples = 4096;
+
+// The convolvers are too large for internal RAM next to the effects, so the benchmark copies
+// live in SDRAM and their numbers are an upper bound on the cost of an internal RAM instance
+static PartitionedConvolver<32, benchMaxIrLength / 32> DSY_SDRAM_BSS benchConvolver32;
+static PartitionedConvolver<64, benchMaxIrLength / 64> DSY_SDRAM_BSS benchConvolver64;
+static PartitionedConvolver<128, benchMaxIrLength / 128> DSY_SDRAM_BSS benchConvolver128;
+
+static float benchIr[benchMaxIrLength];
+static float benchHistory[benchMaxIrLength * 2];
+
+// Keeps the FIR result from being optimized away
+static volatile float benchSink;
+
+// Print a single benchmark result
+static void PrintResult(const char *name, size_t irLength, CycleCounter &counter)
+{
+    debugPrint(name);
+    debugPrint(" ");
+    debugPrint(irLength);
+    debugPrint(" taps: ");
+    debugPrintF(counter.CyclesPerSample(), 1);
+    debugPrint(" cycles/sample, worst ");
+    debugPrint(counter.MaxCycles());
+    debugPrintln(" cycles");
+}
+
+// Time a convolver one sample at a time, the way the audio callback runs it
+template <typename Convolver>
+static void BenchmarkConvolver(const char *name, Convolver &convolver, size_t irLength)
+{
+    CycleCounter counter;
+
+    convolver.Init();
+    convolver.LoadImpulseResponse(benchIr, irLength);
+
+    for (size_t i = 0; i < benchSamples; i++)
+    {
+        float in = ((float)random(-1000, 1000)) / 1000.0f;
+        counter.Start();
+        convolver.Process(in);
+        counter.Stop(1);
+    }
+
+    PrintResult(name, irLength, counter);
+}
+
+// Time a direct form FIR of the same length, using a doubled history so the taps never wrap
+static void BenchmarkDirectFir(size_t irLength)
+{
+    CycleCounter counter;
+    size_t writeIndex = 0;
+
+    for (size_t i = 0; i < irLength * 2; i++)
+    {
+        benchHistory[i] = 0.0f;
+    }
+
+    for (size_t i = 0; i < benchSamples; i++)
+    {
+        float in = ((float)random(-1000, 1000)) / 1000.0f;
+        counter.Start();
+
+        writeIndex = (writeIndex == 0) ? (irLength - 1) : (writeIndex - 1);
+        benchHistory[writeIndex] = in;
+        benchHistory[writeIndex + irLength] = in;
+
+        const float *window = &benchHistory[writeIndex];
+        float acc = 0.0f;
+        for (size_t k = 0; k < irLength; k++)
+        {
+            acc += benchIr[k] * window[k];
+        }
+        benchSink = acc;
+
+        counter.Stop(1);
+    }
+
+    PrintResult("Direct FIR", irLength, counter);
+}
+
+void RunConvolutionBenchmark()
+{
+    const size_t irLengths[] = {512, 1024, 2048, 4096};
+
+    // Decaying noise impulse response
+    for (size_t i = 0; i < benchMaxIrLength; i++)
+    {
+        benchIr[i] = (((float)random(-1000, 1000)) / 1000.0f) * expf(-(float)i / 800.0f);
+    }
+
+    debugPrintln("Convolution benchmark:");
+
+    for (size_t i = 0; i < 4; i++)
+    {
+        BenchmarkConvolver("Partitioned 32", benchConvolver32, irLengths[i]);
+        BenchmarkConvolver("Partitioned 64", benchConvolver64, irLengths[i]);
+        BenchmarkConvolver("Partitioned 128", benchConvolver128, irLengths[i]);
+        BenchmarkDirectFir(irLengths[i]);
+    }
+}
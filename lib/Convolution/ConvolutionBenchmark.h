@@ -0,0 +1,15 @@
+#ifndef CONVOLUTION_BENCHMARK_H
+#define CONVOLUTION_BENCHMARK_H
+
+#include "DaisyDuino.h"
+#include "../../include/PedalConfig.h"
+#include "../Utility/CycleCounter.h"
+#include "PartitionedConvolver.h"
+
+/**
+ * Prints the cost of the partitioned convolver in cycles per sample (average and worst case)
+ * for a range of IR lengths and partition sizes, next to a direct form FIR of the same length
+ */
+void RunConvolutionBenchmark();
+
+#endif
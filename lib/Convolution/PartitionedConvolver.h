@@ -0,0 +1,357 @@
+#ifndef PARTITIONED_CONVOLVER_H
+#define PARTITIONED_CONVOLVER_H
+
+#include "DaisyDuino.h"
+#include "../../include/PedalConfig.h"
+#include "RealFft.h"
+
+/**
+ * Uniformly partitioned overlap-save FFT convolution
+ *
+ * The impulse response is split into partitions of partitionSize taps whose spectra are
+ * calculated once when the IR is loaded. Every partitionSize input samples the new input
+ * frame is transformed, multiplied against all IR partitions through a frequency domain
+ * delay line, and transformed back.
+ *
+ * Since the pedal runs with a block size of 1, that work is not done all at once on the
+ * frame boundary: it is sliced into work units and spread evenly over the samples of the
+ * next frame, which keeps the per-sample cost flat at the price of a latency of
+ * 2 * partitionSize samples.
+ *
+ * There are no default member initializers, so an instance can live in a NOLOAD section
+ * such as DSY_SDRAM_BSS. Init() must be called before use.
+ */
+template <size_t partitionSize, size_t maxPartitions>
+class PartitionedConvolver
+{
+public:
+    /**
+     * Initialize the convolver with an empty (silent) impulse response
+     */
+    void Init()
+    {
+        fft.Init();
+        numPartitions = 1;
+        for (size_t i = 0; i < fftSize; i++)
+        {
+            irSpectra[0][i] = 0.0f;
+        }
+        UpdateBudget();
+        Reset();
+    }
+
+    /**
+     * Clears all of the audio history, keeping the loaded impulse response
+     */
+    void Reset()
+    {
+        for (size_t p = 0; p < maxPartitions; p++)
+        {
+            for (size_t i = 0; i < fftSize; i++)
+            {
+                inputSpectra[p][i] = 0.0f;
+            }
+        }
+        for (size_t i = 0; i < partitionSize; i++)
+        {
+            frameBuffers[0][i] = 0.0f;
+            frameBuffers[1][i] = 0.0f;
+            outputBuffers[0][i] = 0.0f;
+            outputBuffers[1][i] = 0.0f;
+        }
+
+        currentFrame = frameBuffers[0];
+        previousFrame = frameBuffers[1];
+        currentOutput = outputBuffers[0];
+        pendingOutput = outputBuffers[1];
+        newestSpectrum = 0;
+        inputPos = 0;
+        jobPhase = JOB_IDLE;
+        overruns = 0;
+    }
+
+    /**
+     * Calculates the spectra of a new impulse response
+     * Must not be called while Process() can run, since it uses the shared FFT
+     * @param ir Impulse response samples
+     * @param length Number of samples, anything past partitionSize * maxPartitions is ignored
+     */
+    void LoadImpulseResponse(const float *ir, size_t length)
+    {
+        numPartitions = (length + partitionSize - 1) / partitionSize;
+        if (numPartitions > maxPartitions)
+        {
+            numPartitions = maxPartitions;
+        }
+        if (numPartitions == 0)
+        {
+            numPartitions = 1;
+        }
+
+        for (size_t p = 0; p < numPartitions; p++)
+        {
+            // Zero padded partition, transformed in place
+            float *spectrum = irSpectra[p];
+            for (size_t i = 0; i < fftSize; i++)
+            {
+                size_t tap = (p * partitionSize) + i;
+                spectrum[i] = (i < partitionSize && tap < length) ? ir[tap] : 0.0f;
+            }
+            fft.Forward(spectrum);
+        }
+
+        UpdateBudget();
+        Reset();
+    }
+
+    /**
+     * Processes a single sample, the output is delayed by GetLatency() samples
+     */
+    inline float Process(float in)
+    {
+        float out = currentOutput[inputPos];
+        currentFrame[inputPos] = in;
+        inputPos++;
+
+        if (inputPos == partitionSize)
+        {
+            StartFrame();
+        }
+
+        RunJob(unitsPerSample);
+
+        return out;
+    }
+
+    /**
+     * Processes a block of samples, in and out may be the same buffer
+     */
+    void ProcessBlock(const float *in, float *out, size_t size)
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            out[i] = Process(in[i]);
+        }
+    }
+
+    /**
+     * @return Latency of the convolution in samples
+     */
+    size_t GetLatency()
+    {
+        return partitionSize * 2;
+    }
+
+    /**
+     * @return Number of frames whose work did not finish in time and had to be completed on the frame boundary
+     */
+    size_t GetOverruns()
+    {
+        return overruns;
+    }
+
+private:
+    static const size_t fftSize = partitionSize * 2;
+
+    enum JobPhase
+    {
+        JOB_FORWARD,
+        JOB_MULTIPLY,
+        JOB_INVERSE,
+        JOB_OUTPUT,
+        JOB_IDLE
+    };
+
+    /**
+     * Spreads the work of one frame over the samples of the following frame
+     */
+    void UpdateBudget()
+    {
+        size_t totalUnits = (RealFft<fftSize>::WorkUnits() * 2) + (numPartitions * partitionSize) + partitionSize;
+        unitsPerSample = (totalUnits + partitionSize - 1) / partitionSize;
+    }
+
+    /**
+     * Publishes the finished frame and starts the work for the frame that was just filled
+     */
+    void StartFrame()
+    {
+        // The previous frame should be done by now, finish it here if not
+        if (jobPhase != JOB_IDLE)
+        {
+            RunJob(SIZE_MAX);
+            overruns++;
+        }
+
+        float *swap = currentOutput;
+        currentOutput = pendingOutput;
+        pendingOutput = swap;
+
+        // Overlap-save input: the previous frame followed by the new one
+        newestSpectrum = (newestSpectrum + 1) % maxPartitions;
+        float *spectrum = inputSpectra[newestSpectrum];
+        for (size_t i = 0; i < partitionSize; i++)
+        {
+            spectrum[i] = previousFrame[i];
+            spectrum[i + partitionSize] = currentFrame[i];
+        }
+
+        swap = previousFrame;
+        previousFrame = currentFrame;
+        currentFrame = swap;
+        inputPos = 0;
+
+        fft.StartForward(spectrum);
+        jobPhase = JOB_FORWARD;
+    }
+
+    /**
+     * Runs up to budget units of the current frame's work
+     */
+    void RunJob(size_t budget)
+    {
+        while (budget > 0 && jobPhase != JOB_IDLE)
+        {
+            switch (jobPhase)
+            {
+            case JOB_FORWARD:
+                // Whatever the transform leaves over goes to the next phase
+                budget = fft.Step(budget);
+                if (fft.IsDone())
+                {
+                    jobPhase = JOB_MULTIPLY;
+                    jobPartition = 0;
+                    jobBin = 0;
+                }
+                break;
+
+            case JOB_MULTIPLY:
+                budget = RunMultiply(budget);
+                break;
+
+            case JOB_INVERSE:
+                budget = fft.Step(budget);
+                if (fft.IsDone())
+                {
+                    jobPhase = JOB_OUTPUT;
+                    jobBin = 0;
+                }
+                break;
+
+            case JOB_OUTPUT:
+                // The last half of the circular convolution is the valid output, one sample per unit
+                while (budget > 0 && jobBin < partitionSize)
+                {
+                    pendingOutput[jobBin] = accumulator[jobBin + partitionSize];
+                    jobBin++;
+                    budget--;
+                }
+                if (jobBin == partitionSize)
+                {
+                    jobPhase = JOB_IDLE;
+                }
+                break;
+
+            default:
+                jobPhase = JOB_IDLE;
+                break;
+            }
+        }
+    }
+
+    /**
+     * Multiplies and accumulates the input spectra against the IR spectra, one bin per unit
+     */
+    size_t RunMultiply(size_t budget)
+    {
+        while (budget > 0)
+        {
+            size_t slot = (newestSpectrum + maxPartitions - jobPartition) % maxPartitions;
+            const float *x = inputSpectra[slot];
+            const float *h = irSpectra[jobPartition];
+            bool first = (jobPartition == 0);
+
+            // Run as many bins of this partition as the budget allows
+            size_t endBin = jobBin + budget;
+            if (endBin > partitionSize)
+            {
+                endBin = partitionSize;
+            }
+            budget -= endBin - jobBin;
+
+            if (jobBin == 0)
+            {
+                // DC and Nyquist are real and share the first slot
+                accumulator[0] = (first ? 0.0f : accumulator[0]) + (x[0] * h[0]);
+                accumulator[1] = (first ? 0.0f : accumulator[1]) + (x[1] * h[1]);
+                jobBin = 1;
+            }
+
+            for (size_t bin = jobBin; bin < endBin; bin++)
+            {
+                float xr = x[bin * 2];
+                float xi = x[(bin * 2) + 1];
+                float hr = h[bin * 2];
+                float hi = h[(bin * 2) + 1];
+                float re = (xr * hr) - (xi * hi);
+                float im = (xr * hi) + (xi * hr);
+
+                if (first)
+                {
+                    accumulator[bin * 2] = re;
+                    accumulator[(bin * 2) + 1] = im;
+                }
+                else
+                {
+                    accumulator[bin * 2] += re;
+                    accumulator[(bin * 2) + 1] += im;
+                }
+            }
+            jobBin = endBin;
+
+            // Move on to the next partition, or the inverse transform after the last one
+            if (jobBin == partitionSize)
+            {
+                jobBin = 0;
+                jobPartition++;
+                if (jobPartition == numPartitions)
+                {
+                    fft.StartInverse(accumulator);
+                    jobPhase = JOB_INVERSE;
+                    break;
+                }
+            }
+        }
+
+        return budget;
+    }
+
+    RealFft<fftSize> fft;
+
+    // Spectra of the impulse response partitions and the frequency domain delay line of input frames
+    float irSpectra[maxPartitions][fftSize];
+    float inputSpectra[maxPartitions][fftSize];
+    float accumulator[fftSize];
+
+    // Time domain frames, swapped by pointer on every frame boundary
+    float frameBuffers[2][partitionSize];
+    float outputBuffers[2][partitionSize];
+    float *currentFrame;
+    float *previousFrame;
+    float *currentOutput;
+    float *pendingOutput;
+
+    // State
+    size_t numPartitions;
+    size_t newestSpectrum;
+    size_t inputPos;
+    size_t unitsPerSample;
+    size_t overruns;
+
+    // Work in progress for the current frame
+    JobPhase jobPhase;
+    size_t jobPartition;
+    size_t jobBin;
+};
+
+#endif
@@ -0,0 +1,381 @@
+#ifndef REAL_FFT_H
+#define REAL_FFT_H
+
+#include "DaisyDuino.h"
+#include "../../include/PedalConfig.h"
+
+/**
+ * In-place real FFT of fftSize points, computed as a complex FFT of half the size plus a split pass
+ *
+ * The spectrum is packed into the same fftSize floats: [0] is the DC bin, [1] is the Nyquist bin
+ * (both are real) and bins 1 to fftSize/2 - 1 follow as interleaved real/imaginary pairs
+ *
+ * The transform can be run all at once, or started and then advanced a fixed number of
+ * butterflies at a time with Step(), which lets an audio callback spread one transform
+ * over several callbacks with a bounded cost per call
+ */
+template <size_t fftSize>
+class RealFft
+{
+public:
+    /**
+     * Calculates the twiddle and bit reversal tables
+     */
+    void Init()
+    {
+        for (size_t i = 0; i < complexSize / 2; i++)
+        {
+            float phase = -2.0f * PI_VAL * (float)i / (float)complexSize;
+            twiddleCos[i] = cosf(phase);
+            twiddleSin[i] = sinf(phase);
+        }
+
+        for (size_t i = 0; i <= complexSize / 2; i++)
+        {
+            float phase = -2.0f * PI_VAL * (float)i / (float)fftSize;
+            splitCos[i] = cosf(phase);
+            splitSin[i] = sinf(phase);
+        }
+
+        size_t bits = 0;
+        while (((size_t)1 << bits) < complexSize)
+        {
+            bits++;
+        }
+        for (size_t i = 0; i < complexSize; i++)
+        {
+            size_t reversed = 0;
+            for (size_t b = 0; b < bits; b++)
+            {
+                reversed |= ((i >> b) & 1) << (bits - 1 - b);
+            }
+            bitReverse[i] = (uint16_t)reversed;
+        }
+
+        phase = FFT_DONE;
+    }
+
+    /**
+     * Runs a complete forward transform on buf
+     */
+    void Forward(float *buf)
+    {
+        StartForward(buf);
+        Step(SIZE_MAX);
+    }
+
+    /**
+     * Runs a complete inverse transform on buf, including the 1/N scaling
+     */
+    void Inverse(float *buf)
+    {
+        StartInverse(buf);
+        Step(SIZE_MAX);
+    }
+
+    /**
+     * Starts a forward transform that is advanced by Step()
+     */
+    void StartForward(float *buf)
+    {
+        data = buf;
+        inverse = false;
+        phase = FFT_BITREVERSE;
+        index = 0;
+    }
+
+    /**
+     * Starts an inverse transform that is advanced by Step()
+     */
+    void StartInverse(float *buf)
+    {
+        data = buf;
+        inverse = true;
+        phase = FFT_UNSPLIT;
+        index = 0;
+    }
+
+    /**
+     * Advances the current transform
+     * @param budget Maximum number of work units (butterflies, swaps or split iterations) to run
+     * @return Returns the budget left over, non-zero only once the transform is complete (see IsDone())
+     */
+    size_t Step(size_t budget)
+    {
+        while (budget > 0 && phase != FFT_DONE)
+        {
+            switch (phase)
+            {
+            case FFT_UNSPLIT:
+                budget = RunUnsplit(budget);
+                break;
+            case FFT_BITREVERSE:
+                budget = RunBitReverse(budget);
+                break;
+            case FFT_STAGES:
+                budget = RunStages(budget);
+                break;
+            case FFT_SPLIT:
+                budget = RunSplit(budget);
+                break;
+            case FFT_SCALE:
+                budget = RunScale(budget);
+                break;
+            default:
+                phase = FFT_DONE;
+                break;
+            }
+        }
+
+        return budget;
+    }
+
+    /**
+     * @return Returns true if no transform is in progress
+     */
+    bool IsDone()
+    {
+        return phase == FFT_DONE;
+    }
+
+    /**
+     * @return Number of work units Step() needs to finish a transform
+     */
+    static size_t WorkUnits()
+    {
+        size_t stages = 0;
+        while (((size_t)1 << stages) < complexSize)
+        {
+            stages++;
+        }
+
+        // Bit reversal, butterflies, split (or unsplit) and the inverse scaling
+        return complexSize + (stages * complexSize / 2) + (complexSize / 2) + complexSize;
+    }
+
+private:
+    static const size_t complexSize = fftSize / 2;
+
+    enum FftPhase
+    {
+        FFT_UNSPLIT,
+        FFT_BITREVERSE,
+        FFT_STAGES,
+        FFT_SPLIT,
+        FFT_SCALE,
+        FFT_DONE
+    };
+
+    size_t RunBitReverse(size_t budget)
+    {
+        while (budget > 0 && index < complexSize)
+        {
+            size_t reversed = bitReverse[index];
+            if (reversed > index)
+            {
+                float re = data[index * 2];
+                float im = data[(index * 2) + 1];
+                data[index * 2] = data[reversed * 2];
+                data[(index * 2) + 1] = data[(reversed * 2) + 1];
+                data[reversed * 2] = re;
+                data[(reversed * 2) + 1] = im;
+            }
+            index++;
+            budget--;
+        }
+
+        if (index == complexSize)
+        {
+            phase = FFT_STAGES;
+            stageLength = 2;
+            groupStart = 0;
+            index = 0;
+        }
+
+        return budget;
+    }
+
+    size_t RunStages(size_t budget)
+    {
+        const float sign = inverse ? -1.0f : 1.0f;
+
+        while (budget > 0)
+        {
+            size_t half = stageLength / 2;
+            size_t twiddleIndex = index * (complexSize / stageLength);
+            float wr = twiddleCos[twiddleIndex];
+            float wi = sign * twiddleSin[twiddleIndex];
+
+            float *a = &data[(groupStart + index) * 2];
+            float *b = &data[(groupStart + index + half) * 2];
+            float tr = (b[0] * wr) - (b[1] * wi);
+            float ti = (b[0] * wi) + (b[1] * wr);
+            b[0] = a[0] - tr;
+            b[1] = a[1] - ti;
+            a[0] += tr;
+            a[1] += ti;
+            budget--;
+
+            // Move to the next butterfly, group and stage
+            index++;
+            if (index == half)
+            {
+                index = 0;
+                groupStart += stageLength;
+                if (groupStart >= complexSize)
+                {
+                    groupStart = 0;
+                    stageLength *= 2;
+                    if (stageLength > complexSize)
+                    {
+                        phase = inverse ? FFT_SCALE : FFT_SPLIT;
+                        index = inverse ? 0 : 1;
+                        if (!inverse)
+                        {
+                            SplitDc();
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+
+        return budget;
+    }
+
+    // The DC and Nyquist bins are both real and are packed into the first complex slot
+    void SplitDc()
+    {
+        float re = data[0];
+        float im = data[1];
+        data[0] = re + im;
+        data[1] = re - im;
+    }
+
+    size_t RunSplit(size_t budget)
+    {
+        while (budget > 0 && index <= complexSize / 2)
+        {
+            size_t k = index;
+            size_t mk = complexSize - k;
+            float a = data[k * 2];
+            float b = data[(k * 2) + 1];
+            float c = data[mk * 2];
+            float d = data[(mk * 2) + 1];
+
+            // Even and odd half spectra
+            float evenRe = (a + c) * 0.5f;
+            float evenIm = (b - d) * 0.5f;
+            float oddRe = (b + d) * 0.5f;
+            float oddIm = (c - a) * 0.5f;
+
+            // Rotate the odd half by the split twiddle
+            float wr = splitCos[k];
+            float wi = splitSin[k];
+            float rotRe = (oddRe * wr) - (oddIm * wi);
+            float rotIm = (oddRe * wi) + (oddIm * wr);
+
+            data[k * 2] = evenRe + rotRe;
+            data[(k * 2) + 1] = evenIm + rotIm;
+            data[mk * 2] = evenRe - rotRe;
+            data[(mk * 2) + 1] = rotIm - evenIm;
+
+            index++;
+            budget--;
+        }
+
+        if (index > complexSize / 2)
+        {
+            phase = FFT_DONE;
+        }
+
+        return budget;
+    }
+
+    size_t RunUnsplit(size_t budget)
+    {
+        if (index == 0)
+        {
+            float dc = data[0];
+            float nyquist = data[1];
+            data[0] = (dc + nyquist) * 0.5f;
+            data[1] = (dc - nyquist) * 0.5f;
+            index = 1;
+        }
+
+        while (budget > 0 && index <= complexSize / 2)
+        {
+            size_t k = index;
+            size_t mk = complexSize - k;
+            float a = data[k * 2];
+            float b = data[(k * 2) + 1];
+            float c = data[mk * 2];
+            float d = data[(mk * 2) + 1];
+
+            float evenRe = (a + c) * 0.5f;
+            float evenIm = (b - d) * 0.5f;
+            float diffRe = (a - c) * 0.5f;
+            float diffIm = (b + d) * 0.5f;
+
+            // Undo the split twiddle rotation (multiply by its conjugate)
+            float wr = splitCos[k];
+            float wi = -splitSin[k];
+            float oddRe = (diffRe * wr) - (diffIm * wi);
+            float oddIm = (diffRe * wi) + (diffIm * wr);
+
+            // Z[k] = even + i * odd and Z[N - k] = conj(even) + i * conj(odd)
+            data[k * 2] = evenRe - oddIm;
+            data[(k * 2) + 1] = evenIm + oddRe;
+            data[mk * 2] = evenRe + oddIm;
+            data[(mk * 2) + 1] = oddRe - evenIm;
+
+            index++;
+            budget--;
+        }
+
+        if (index > complexSize / 2)
+        {
+            phase = FFT_BITREVERSE;
+            index = 0;
+        }
+
+        return budget;
+    }
+
+    size_t RunScale(size_t budget)
+    {
+        const float scale = 1.0f / (float)complexSize;
+
+        while (budget > 0 && index < complexSize)
+        {
+            data[index * 2] *= scale;
+            data[(index * 2) + 1] *= scale;
+            index++;
+            budget--;
+        }
+
+        if (index == complexSize)
+        {
+            phase = FFT_DONE;
+        }
+
+        return budget;
+    }
+
+    // Tables
+    float twiddleCos[complexSize / 2];
+    float twiddleSin[complexSize / 2];
+    float splitCos[complexSize / 2 + 1];
+    float splitSin[complexSize / 2 + 1];
+    uint16_t bitReverse[complexSize];
+
+    // Transform in progress
+    float *data;
+    bool inverse;
+    FftPhase phase;
+    size_t index;
+    size_t stageLength;
+    size_t groupStart;
+};
+
+#endif
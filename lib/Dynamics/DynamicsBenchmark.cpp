@@ -0,0 +1,95 @@
+#include "DynamicsBenchmark.h"
+
+static const size_t benchSamples = 9600;
+static const float benchThreshold = 0.98f;
+
+// Plucked notes driven well past the threshold, like the echo with the boost turned up
+static const float benchToneFreq = 220.0f;
+static const float benchPeakLevel = 4.0f;
+static const size_t benchNoteSamples = 2400;
+
+static float DSY_SDRAM_BSS benchIn[benchSamples];
+static float benchRequired[maxLimiterLookahead];
+
+// Window minimum by scanning the whole window every sample, what the deque replaces
+static float NaiveWindowMin(float required, size_t index, size_t length)
+{
+    benchRequired[index % length] = required;
+
+    float minimum = 1.0f;
+    for (size_t i = 0; i < length; i++)
+    {
+        if (benchRequired[i] < minimum)
+        {
+            minimum = benchRequired[i];
+        }
+    }
+    return minimum;
+}
+
+void RunDynamicsBenchmark()
+{
+    const size_t lookaheads[] = {8, 32, 64, 128};
+
+    CycleCounter counter;
+    CycleCounter naiveCounter;
+    LookaheadLimiter limiter;
+
+    for (size_t i = 0; i < benchSamples; i++)
+    {
+        float t = (float)(i % benchNoteSamples) / sampleRateHz;
+        benchIn[i] = benchPeakLevel * expf(-8.0f * t) * sinf(2.0f * PI_VAL * benchToneFreq * t);
+    }
+
+    debugPrintln("Dynamics benchmark:");
+
+    for (size_t l = 0; l < 4; l++)
+    {
+        limiter.Init(sampleRateHz, lookaheads[l]);
+        limiter.SetThreshold(benchThreshold);
+
+        counter.Reset();
+        float peak = 0.0f;
+        for (size_t i = 0; i < benchSamples; i++)
+        {
+            counter.Start();
+            float out = limiter.Process(benchIn[i]);
+            counter.Stop(1);
+
+            if (fabsf(out) > peak)
+            {
+                peak = fabsf(out);
+            }
+        }
+
+        // Just the window minimum done the slow way, for comparison
+        for (size_t i = 0; i < lookaheads[l]; i++)
+        {
+            benchRequired[i] = 1.0f;
+        }
+        naiveCounter.Reset();
+        volatile float sink = 0.0f;
+        for (size_t i = 0; i < benchSamples; i++)
+        {
+            float level = fabsf(benchIn[i]);
+            float required = (level > benchThreshold) ? (benchThreshold / level) : 1.0f;
+
+            naiveCounter.Start();
+            sink = NaiveWindowMin(required, i, lookaheads[l]);
+            naiveCounter.Stop(1);
+        }
+        (void)sink;
+
+        debugPrint("Lookahead ");
+        debugPrint(lookaheads[l]);
+        debugPrint(": ");
+        debugPrintF(counter.CyclesPerSample(), 1);
+        debugPrint(" cycles/sample, worst ");
+        debugPrint(counter.MaxCycles());
+        debugPrint(" cycles, naive window min ");
+        debugPrintF(naiveCounter.CyclesPerSample(), 1);
+        debugPrint(" cycles/sample, peak out ");
+        debugPrintF(peak, 4);
+        debugPrintln(peak <= benchThreshold * 1.0001f ? "" : " OVER THRESHOLD");
+    }
+}
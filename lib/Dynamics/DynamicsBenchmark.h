@@ -0,0 +1,15 @@
+#ifndef DYNAMICS_BENCHMARK_H
+#define DYNAMICS_BENCHMARK_H
+
+#include "DaisyDuino.h"
+#include "../../include/PedalConfig.h"
+#include "../Utility/CycleCounter.h"
+#include "LookaheadLimiter.h"
+
+/**
+ * Measures the lookahead limiter cost in cycles per sample across lookahead lengths, next to a naive
+ * window scan, and checks the output peak never passes the threshold
+ */
+void RunDynamicsBenchmark();
+
+#endif
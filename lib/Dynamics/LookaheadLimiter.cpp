@@ -0,0 +1,105 @@
+#include "LookaheadLimiter.h"
+
+static const size_t limiterMask = maxLimiterLookahead - 1;
+
+void LookaheadLimiter::Init(float pSampleRate, size_t pLookahead)
+{
+    sampleRate = pSampleRate;
+    threshold = 1.0f;
+    SetRelease(100.0f);
+    SetLookahead(pLookahead);
+}
+
+void LookaheadLimiter::Reset()
+{
+    for (size_t i = 0; i < maxLimiterLookahead; i++)
+    {
+        delayBuffer[i] = 0.0f;
+        boxBuffer[i] = 1.0f;
+    }
+
+    // The box window starts full of unity gain
+    boxSum = (double)lookahead;
+    releaseGain = 1.0f;
+    gain = 1.0f;
+    sampleIndex = 0;
+    dequeFront = 0;
+    dequeBack = 0;
+}
+
+void LookaheadLimiter::SetLookahead(size_t pLookahead)
+{
+    lookahead = (pLookahead < 1) ? 1 : ((pLookahead > maxLimiterLookahead) ? maxLimiterLookahead : pLookahead);
+    boxScale = 1.0f / (float)lookahead;
+    Reset();
+}
+
+void LookaheadLimiter::SetThreshold(float pThreshold)
+{
+    threshold = pThreshold;
+}
+
+void LookaheadLimiter::SetRelease(float releaseMs)
+{
+    float samples = (releaseMs / 1000.0f) * sampleRate;
+    releaseCoeff = (samples > 1.0f) ? (1.0f - expf(-1.0f / samples)) : 1.0f;
+}
+
+ITCM_FUNC float LookaheadLimiter::Process(float in)
+{
+    // Gain this sample needs to stay under the threshold
+    float level = fabsf(in);
+    float required = (level > threshold) ? (threshold / level) : 1.0f;
+
+    // Drop the minimum once it has left the window, then every entry it makes redundant
+    if (dequeFront != dequeBack && (sampleIndex - dequeIndex[dequeFront & limiterMask]) >= lookahead)
+    {
+        dequeFront++;
+    }
+    while (dequeFront != dequeBack && dequeGain[(dequeBack - 1) & limiterMask] >= required)
+    {
+        dequeBack--;
+    }
+    dequeGain[dequeBack & limiterMask] = required;
+    dequeIndex[dequeBack & limiterMask] = sampleIndex;
+    dequeBack++;
+    float held = dequeGain[dequeFront & limiterMask];
+
+    // Attack is instant (the lookahead and box average shape it), release is a one pole rise
+    if (held < releaseGain)
+    {
+        releaseGain = held;
+    }
+    else
+    {
+        releaseGain += (held - releaseGain) * releaseCoeff;
+    }
+
+    // Box average over the window, the double accumulator does not drift over long runs
+    size_t position = sampleIndex & limiterMask;
+    size_t oldest = (sampleIndex - lookahead) & limiterMask;
+    boxSum += (double)releaseGain - (double)boxBuffer[oldest];
+    boxBuffer[position] = releaseGain;
+    gain = (float)boxSum * boxScale;
+    if (gain > 1.0f)
+    {
+        gain = 1.0f;
+    }
+
+    // Delay the input so the gain has fully dropped by the time a peak comes out
+    delayBuffer[position] = in;
+    float delayed = delayBuffer[(sampleIndex - (lookahead - 1)) & limiterMask];
+
+    sampleIndex++;
+    return delayed * gain;
+}
+
+float LookaheadLimiter::GetGain()
+{
+    return gain;
+}
+
+size_t LookaheadLimiter::GetLatency()
+{
+    return lookahead - 1;
+}
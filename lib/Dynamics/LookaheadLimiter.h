@@ -0,0 +1,89 @@
+#ifndef LOOKAHEAD_LIMITER_H
+#define LOOKAHEAD_LIMITER_H
+
+#include "DaisyDuino.h"
+#include "../../include/PedalConfig.h"
+#include "../Utility/MemoryPlacement.h"
+
+// Longest supported lookahead in samples, a power of two (1.3ms at 96kHz)
+static const size_t maxLimiterLookahead = 128;
+
+/**
+ * Brickwall peak limiter that sees lookahead samples into the future
+ *
+ * Each sample's required gain (threshold / |x| above the threshold) goes through a sliding window minimum
+ * over the lookahead, so the gain starts dropping lookahead samples before a peak. A monotonic deque keeps
+ * the minimum in amortized O(1) per sample whatever the lookahead. Gain recovers through a one pole release
+ * and is then smoothed by a box average over the same window, which still reaches the required gain by the
+ * time the peak leaves the input delay, so the output never exceeds the threshold.
+ *
+ * Latency is lookahead - 1 samples.
+ */
+class LookaheadLimiter
+{
+public:
+    /**
+     * Initialize the limiter with no gain reduction
+     * @param pSampleRate Sample rate the limiter runs at
+     * @param pLookahead Lookahead in samples, 1 to maxLimiterLookahead
+     */
+    void Init(float pSampleRate, size_t pLookahead);
+
+    /**
+     * Clears the input delay and the gain state
+     */
+    void Reset();
+
+    /**
+     * Sets the lookahead in samples, 1 to maxLimiterLookahead, clears the limiter
+     */
+    void SetLookahead(size_t pLookahead);
+
+    /**
+     * Sets the highest output level (linear)
+     */
+    void SetThreshold(float pThreshold);
+
+    /**
+     * Sets the time constant of the gain recovery in milliseconds
+     */
+    void SetRelease(float releaseMs);
+
+    /**
+     * Processes a single sample
+     */
+    float Process(float in);
+
+    /**
+     * @return Gain applied to the last output sample, 1 when not limiting
+     */
+    float GetGain();
+
+    /**
+     * @return Latency added by the input delay, in samples
+     */
+    size_t GetLatency();
+
+private:
+    float sampleRate = sampleRateHz;
+    size_t lookahead = 1;
+    float threshold = 1.0f;
+    float releaseCoeff = 1.0f;
+    float releaseGain = 1.0f;
+    float gain = 1.0f;
+    uint32_t sampleIndex = 0;
+
+    // Input delay and the box average window, both indexed by the sample index
+    float delayBuffer[maxLimiterLookahead];
+    float boxBuffer[maxLimiterLookahead];
+    double boxSum = 0.0;
+    float boxScale = 1.0f;
+
+    // Monotonic deque of required gains, increasing from front to back, front is the window minimum
+    float dequeGain[maxLimiterLookahead];
+    uint32_t dequeIndex[maxLimiterLookahead];
+    size_t dequeFront = 0;
+    size_t dequeBack = 0;
+};
+
+#endif
@@ -0,0 +1,140 @@
+#include "BiquadFilter.h"
+
+// Coefficient formulas are from the RBJ Audio EQ Cookbook
+
+void BiquadFilter::Init(float pSampleRate)
+{
+    sampleRate = pSampleRate;
+
+    // Start as a pass-through section
+    SetNormalized(1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f);
+    coeffs = pendingCoeffs;
+    coeffsPending = false;
+
+    Reset();
+}
+
+void BiquadFilter::Reset()
+{
+    s1 = 0.0f;
+    s2 = 0.0f;
+}
+
+void BiquadFilter::SetLowpass(float freq, float q)
+{
+    float w0 = 2.0f * PI_VAL * freq / sampleRate;
+    float cosW0 = cosf(w0);
+    float alpha = sinf(w0) / (2.0f * q);
+
+    SetNormalized((1.0f - cosW0) / 2.0f, 1.0f - cosW0, (1.0f - cosW0) / 2.0f,
+                  1.0f + alpha, -2.0f * cosW0, 1.0f - alpha);
+}
+
+void BiquadFilter::SetHighpass(float freq, float q)
+{
+    float w0 = 2.0f * PI_VAL * freq / sampleRate;
+    float cosW0 = cosf(w0);
+    float alpha = sinf(w0) / (2.0f * q);
+
+    SetNormalized((1.0f + cosW0) / 2.0f, -(1.0f + cosW0), (1.0f + cosW0) / 2.0f,
+                  1.0f + alpha, -2.0f * cosW0, 1.0f - alpha);
+}
+
+void BiquadFilter::SetBandpass(float freq, float q)
+{
+    float w0 = 2.0f * PI_VAL * freq / sampleRate;
+    float cosW0 = cosf(w0);
+    float alpha = sinf(w0) / (2.0f * q);
+
+    // Constant 0dB peak gain
+    SetNormalized(alpha, 0.0f, -alpha, 1.0f + alpha, -2.0f * cosW0, 1.0f - alpha);
+}
+
+void BiquadFilter::SetPeak(float freq, float q, float gainDb)
+{
+    float a = powf(10.0f, gainDb / 40.0f);
+    float w0 = 2.0f * PI_VAL * freq / sampleRate;
+    float cosW0 = cosf(w0);
+    float alpha = sinf(w0) / (2.0f * q);
+
+    SetNormalized(1.0f + (alpha * a), -2.0f * cosW0, 1.0f - (alpha * a),
+                  1.0f + (alpha / a), -2.0f * cosW0, 1.0f - (alpha / a));
+}
+
+void BiquadFilter::SetLowShelf(float freq, float gainDb)
+{
+    float a = powf(10.0f, gainDb / 40.0f);
+    float w0 = 2.0f * PI_VAL * freq / sampleRate;
+    float cosW0 = cosf(w0);
+
+    // Shelf slope of 1
+    float alpha = sinf(w0) / 2.0f * sqrtf(2.0f);
+    float sqrtA = 2.0f * sqrtf(a) * alpha;
+
+    SetNormalized(a * ((a + 1.0f) - ((a - 1.0f) * cosW0) + sqrtA),
+                  2.0f * a * ((a - 1.0f) - ((a + 1.0f) * cosW0)),
+                  a * ((a + 1.0f) - ((a - 1.0f) * cosW0) - sqrtA),
+                  (a + 1.0f) + ((a - 1.0f) * cosW0) + sqrtA,
+                  -2.0f * ((a - 1.0f) + ((a + 1.0f) * cosW0)),
+                  (a + 1.0f) + ((a - 1.0f) * cosW0) - sqrtA);
+}
+
+void BiquadFilter::SetHighShelf(float freq, float gainDb)
+{
+    float a = powf(10.0f, gainDb / 40.0f);
+    float w0 = 2.0f * PI_VAL * freq / sampleRate;
+    float cosW0 = cosf(w0);
+
+    // Shelf slope of 1
+    float alpha = sinf(w0) / 2.0f * sqrtf(2.0f);
+    float sqrtA = 2.0f * sqrtf(a) * alpha;
+
+    SetNormalized(a * ((a + 1.0f) + ((a - 1.0f) * cosW0) + sqrtA),
+                  -2.0f * a * ((a - 1.0f) + ((a + 1.0f) * cosW0)),
+                  a * ((a + 1.0f) + ((a - 1.0f) * cosW0) - sqrtA),
+                  (a + 1.0f) - ((a - 1.0f) * cosW0) + sqrtA,
+                  2.0f * ((a - 1.0f) - ((a + 1.0f) * cosW0)),
+                  (a + 1.0f) - ((a - 1.0f) * cosW0) - sqrtA);
+}
+
+void BiquadFilter::ProcessBlock(const float *in, float *out, size_t size)
+{
+    UpdateCoefficients();
+
+    // Work on local copies so the compiler can keep everything in registers
+    const float b0 = coeffs.b0;
+    const float b1 = coeffs.b1;
+    const float b2 = coeffs.b2;
+    const float a1 = coeffs.a1;
+    const float a2 = coeffs.a2;
+    float z1 = s1;
+    float z2 = s2;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        float x = in[i];
+        float y = (b0 * x) + z1;
+        z1 = (b1 * x) - (a1 * y) + z2;
+        z2 = (b2 * x) - (a2 * y);
+        out[i] = y;
+    }
+
+    s1 = z1;
+    s2 = z2;
+}
+
+void BiquadFilter::SetNormalized(float b0, float b1, float b2, float a0, float a1, float a2)
+{
+    Coefficients normalized;
+    normalized.b0 = b0 / a0;
+    normalized.b1 = b1 / a0;
+    normalized.b2 = b2 / a0;
+    normalized.a1 = a1 / a0;
+    normalized.a2 = a2 / a0;
+
+    // Hand the new set to the audio callback, which must not see it half written or before the flag
+    __disable_irq();
+    pendingCoeffs = normalized;
+    coeffsPending = true;
+    __enable_irq();
+}
@@ -0,0 +1,139 @@
+#ifndef BIQUAD_FILTER_H
+#define BIQUAD_FILTER_H
+
+#include "DaisyDuino.h"
+#include "../../include/PedalConfig.h"
+
+/**
+ * Second order IIR filter section in transposed direct form II
+ * Coefficients are calculated by the Set functions, which are meant to be called
+ * at control rate (from Loop), and are picked up by the audio callback on the next block
+ */
+class BiquadFilter
+{
+public:
+    /**
+     * Initialize the filter as a pass-through section
+     * @param pSampleRate Sample rate the filter runs at
+     */
+    void Init(float pSampleRate);
+
+    /**
+     * Clears the filter state without touching the coefficients
+     */
+    void Reset();
+
+    /**
+     * These functions calculate new coefficients for the common filter shapes
+     */
+    void SetLowpass(float freq, float q);
+    void SetHighpass(float freq, float q);
+    void SetBandpass(float freq, float q);
+    void SetPeak(float freq, float q, float gainDb);
+    void SetLowShelf(float freq, float gainDb);
+    void SetHighShelf(float freq, float gainDb);
+
+    /**
+     * Processes a single sample through the filter
+     */
+    inline float Process(float in)
+    {
+        UpdateCoefficients();
+        return Tick(in);
+    }
+
+    /**
+     * Processes a block of samples, in and out may be the same buffer
+     */
+    void ProcessBlock(const float *in, float *out, size_t size);
+
+private:
+    struct Coefficients
+    {
+        float b0, b1, b2, a1, a2;
+    };
+
+    inline float Tick(float in)
+    {
+        float out = (coeffs.b0 * in) + s1;
+        s1 = (coeffs.b1 * in) - (coeffs.a1 * out) + s2;
+        s2 = (coeffs.b2 * in) - (coeffs.a2 * out);
+        return out;
+    }
+
+    inline void UpdateCoefficients()
+    {
+        if (coeffsPending)
+        {
+            coeffs = pendingCoeffs;
+            coeffsPending = false;
+        }
+    }
+
+    void SetNormalized(float b0, float b1, float b2, float a0, float a1, float a2);
+
+    float sampleRate = sampleRateHz;
+    Coefficients coeffs = {1.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    Coefficients pendingCoeffs = {1.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    volatile bool coeffsPending = false;
+
+    // Filter state
+    float s1 = 0.0f;
+    float s2 = 0.0f;
+};
+
+/**
+ * Series of biquad sections processed one section at a time over a block,
+ * which keeps each section's coefficients and state in registers for the whole block
+ */
+template <size_t numSections>
+class BiquadFilterCascade
+{
+public:
+    void Init(float pSampleRate)
+    {
+        for (size_t i = 0; i < numSections; i++)
+        {
+            sections[i].Init(pSampleRate);
+        }
+    }
+
+    void Reset()
+    {
+        for (size_t i = 0; i < numSections; i++)
+        {
+            sections[i].Reset();
+        }
+    }
+
+    /**
+     * Returns a section so its coefficients can be set
+     */
+    BiquadFilter &Section(size_t index)
+    {
+        return sections[index];
+    }
+
+    inline float Process(float in)
+    {
+        for (size_t i = 0; i < numSections; i++)
+        {
+            in = sections[i].Process(in);
+        }
+        return in;
+    }
+
+    void ProcessBlock(const float *in, float *out, size_t size)
+    {
+        sections[0].ProcessBlock(in, out, size);
+        for (size_t i = 1; i < numSections; i++)
+        {
+            sections[i].ProcessBlock(out, out, size);
+        }
+    }
+
+private:
+    BiquadFilter sections[numSections];
+};
+
+#endif
@@ -0,0 +1,99 @@
+#include "FilterBenchmark.h"
+
+static const size_t benchBlockSize = 256;
+static const size_t benchIterations = 64;
+
+static float benchIn[benchBlockSize];
+static float benchOut[benchBlockSize];
+
+// Print a single benchmark result
+static void PrintResult(const char *name, CycleCounter &counter)
+{
+    debugPrint(name);
+    debugPrint(": ");
+    debugPrintF(counter.CyclesPerSample(), 2);
+    debugPrintln(" cycles/sample");
+}
+
+void RunFilterBenchmark()
+{
+    CycleCounter counter;
+    BiquadFilter biquad;
+    BiquadFilterCascade<4> cascade;
+    OnePoleFilter onePole;
+    StateVariableFilter svf;
+
+    // Fill the input with white noise
+    for (size_t i = 0; i < benchBlockSize; i++)
+    {
+        benchIn[i] = ((float)random(-1000, 1000)) / 1000.0f;
+    }
+
+    debugPrintln("Filter benchmark, per section:");
+
+    // BiquadFilter, one sample at a time (the BLOCKSIZE 1 path)
+    biquad.Init(sampleRateHz);
+    biquad.SetLowpass(2000.0f, 0.707f);
+    for (size_t n = 0; n < benchIterations; n++)
+    {
+        counter.Start();
+        for (size_t i = 0; i < benchBlockSize; i++)
+        {
+            benchOut[i] = biquad.Process(benchIn[i]);
+        }
+        counter.Stop(benchBlockSize);
+    }
+    PrintResult("BiquadFilter (per sample)", counter);
+
+    // BiquadFilter, block processing
+    counter.Reset();
+    for (size_t n = 0; n < benchIterations; n++)
+    {
+        counter.Start();
+        biquad.ProcessBlock(benchIn, benchOut, benchBlockSize);
+        counter.Stop(benchBlockSize);
+    }
+    PrintResult("BiquadFilter (block)", counter);
+
+    // BiquadFilter cascade, block processing, reported per section
+    cascade.Init(sampleRateHz);
+    for (size_t s = 0; s < 4; s++)
+    {
+        cascade.Section(s).SetPeak(500.0f * (s + 1), 1.0f, 3.0f);
+    }
+    counter.Reset();
+    for (size_t n = 0; n < benchIterations; n++)
+    {
+        counter.Start();
+        cascade.ProcessBlock(benchIn, benchOut, benchBlockSize);
+        counter.Stop(benchBlockSize * 4);
+    }
+    PrintResult("BiquadFilterCascade<4> (block)", counter);
+
+    // One pole
+    onePole.Init(sampleRateHz);
+    onePole.SetFrequency(2000.0f);
+    counter.Reset();
+    for (size_t n = 0; n < benchIterations; n++)
+    {
+        counter.Start();
+        for (size_t i = 0; i < benchBlockSize; i++)
+        {
+            benchOut[i] = onePole.Process(benchIn[i]);
+        }
+        counter.Stop(benchBlockSize);
+    }
+    PrintResult("OnePoleFilter (per sample)", counter);
+
+    // State variable
+    svf.Init(sampleRateHz);
+    svf.SetFrequency(2000.0f, 0.707f);
+    counter.Reset();
+    for (size_t n = 0; n < benchIterations; n++)
+    {
+        counter.Start();
+        svf.ProcessLowpassBlock(benchIn, benchOut, benchBlockSize);
+        counter.Stop(benchBlockSize);
+    }
+    PrintResult("StateVariableFilter (block)", counter);
+}
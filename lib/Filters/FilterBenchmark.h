@@ -0,0 +1,17 @@
+#ifndef FILTER_BENCHMARK_H
+#define FILTER_BENCHMARK_H
+
+#include "DaisyDuino.h"
+#include "../../include/PedalConfig.h"
+#include "../Utility/CycleCounter.h"
+#include "BiquadFilter.h"
+#include "OnePoleFilter.h"
+#include "StateVariableFilter.h"
+
+/**
+ * Runs each filter in the library over a block of noise and prints the cost
+ * in cycles per section per sample, so new effects can budget their filters
+ */
+void RunFilterBenchmark();
+
+#endif
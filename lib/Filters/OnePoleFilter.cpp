@@ -0,0 +1,38 @@
+#include "OnePoleFilter.h"
+
+void OnePoleFilter::Init(float pSampleRate)
+{
+    sampleRate = pSampleRate;
+    coeff = 1.0f;
+    Reset();
+}
+
+void OnePoleFilter::Reset()
+{
+    state = 0.0f;
+}
+
+void OnePoleFilter::SetFrequency(float freq)
+{
+    // Matched pole position, clamped to Nyquist
+    if (freq > sampleRate / 2.0f)
+    {
+        freq = sampleRate / 2.0f;
+    }
+
+    coeff = 1.0f - expf(-2.0f * PI_VAL * freq / sampleRate);
+}
+
+void OnePoleFilter::ProcessBlock(const float *in, float *out, size_t size)
+{
+    const float c = coeff;
+    float z = state;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        z += c * (in[i] - z);
+        out[i] = z;
+    }
+
+    state = z;
+}
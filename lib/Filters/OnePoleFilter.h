@@ -0,0 +1,58 @@
+#ifndef ONE_POLE_FILTER_H
+#define ONE_POLE_FILTER_H
+
+#include "DaisyDuino.h"
+#include "../../include/PedalConfig.h"
+
+/**
+ * One pole lowpass/highpass filter, the cheapest tone control available (one multiply-add per sample)
+ * The cutoff is set at control rate, the audio callback only reads the coefficient
+ */
+class OnePoleFilter
+{
+public:
+    /**
+     * Initialize the filter fully open
+     * @param pSampleRate Sample rate the filter runs at
+     */
+    void Init(float pSampleRate);
+
+    /**
+     * Clears the filter state
+     */
+    void Reset();
+
+    /**
+     * Sets the -3dB cutoff frequency of the filter
+     */
+    void SetFrequency(float freq);
+
+    /**
+     * Processes a single sample and returns the lowpass output
+     */
+    inline float Process(float in)
+    {
+        state += coeff * (in - state);
+        return state;
+    }
+
+    /**
+     * Processes a single sample and returns the highpass output
+     */
+    inline float ProcessHighpass(float in)
+    {
+        return in - Process(in);
+    }
+
+    /**
+     * Processes a block of samples through the lowpass, in and out may be the same buffer
+     */
+    void ProcessBlock(const float *in, float *out, size_t size);
+
+private:
+    float sampleRate = sampleRateHz;
+    float coeff = 1.0f;
+    float state = 0.0f;
+};
+
+#endif
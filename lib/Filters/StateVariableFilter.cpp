@@ -0,0 +1,46 @@
+#include "StateVariableFilter.h"
+
+// Topology is from Andrew Simper's "Solving the continuous SVF equations using trapezoidal integration"
+
+void StateVariableFilter::Init(float pSampleRate)
+{
+    sampleRate = pSampleRate;
+    SetFrequency(1000.0f, 0.707f);
+    Reset();
+}
+
+void StateVariableFilter::Reset()
+{
+    ic1eq = 0.0f;
+    ic2eq = 0.0f;
+}
+
+void StateVariableFilter::SetFrequency(float freq, float q)
+{
+    // Keep the prewarped cutoff below Nyquist
+    if (freq > sampleRate * 0.49f)
+    {
+        freq = sampleRate * 0.49f;
+    }
+
+    float g = tanf(PI_VAL * freq / sampleRate);
+    float newK = 1.0f / q;
+    float newA1 = 1.0f / (1.0f + (g * (g + newK)));
+    float newA2 = g * newA1;
+
+    // The audio callback must not run with a mix of old and new coefficients
+    __disable_irq();
+    k = newK;
+    a1 = newA1;
+    a2 = newA2;
+    a3 = g * newA2;
+    __enable_irq();
+}
+
+void StateVariableFilter::ProcessLowpassBlock(const float *in, float *out, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        out[i] = Process(in[i]).low;
+    }
+}
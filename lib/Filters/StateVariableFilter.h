@@ -0,0 +1,74 @@
+#ifndef STATE_VARIABLE_FILTER_H
+#define STATE_VARIABLE_FILTER_H
+
+#include "DaisyDuino.h"
+#include "../../include/PedalConfig.h"
+
+/**
+ * Trapezoidal (zero delay feedback) state variable filter
+ * Gives lowpass, bandpass and highpass outputs at once and stays stable under fast cutoff changes
+ */
+class StateVariableFilter
+{
+public:
+    /**
+     * Outputs of a single processed sample
+     */
+    struct Output
+    {
+        float low;
+        float band;
+        float high;
+    };
+
+    /**
+     * Initialize the filter
+     * @param pSampleRate Sample rate the filter runs at
+     */
+    void Init(float pSampleRate);
+
+    /**
+     * Clears the filter state
+     */
+    void Reset();
+
+    /**
+     * Sets the cutoff frequency and resonance (q of 0.707 is Butterworth)
+     */
+    void SetFrequency(float freq, float q);
+
+    /**
+     * Processes a single sample and returns all three outputs
+     */
+    inline Output Process(float in)
+    {
+        Output out;
+        float v3 = in - ic2eq;
+        out.band = (a1 * ic1eq) + (a2 * v3);
+        out.low = ic2eq + (a2 * ic1eq) + (a3 * v3);
+        out.high = in - (k * out.band) - out.low;
+        ic1eq = (2.0f * out.band) - ic1eq;
+        ic2eq = (2.0f * out.low) - ic2eq;
+        return out;
+    }
+
+    /**
+     * Processes a block of samples and writes the lowpass output, in and out may be the same buffer
+     */
+    void ProcessLowpassBlock(const float *in, float *out, size_t size);
+
+private:
+    float sampleRate = sampleRateHz;
+
+    // Coefficients
+    float k = 1.414f;
+    float a1 = 0.0f;
+    float a2 = 0.0f;
+    float a3 = 0.0f;
+
+    // Integrator states
+    float ic1eq = 0.0f;
+    float ic2eq = 0.0f;
+};
+
+#endif
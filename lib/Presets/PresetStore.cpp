@@ -0,0 +1,368 @@
+#include "PresetStore.h"
+#include <string.h>
+
+// RECORD LAYOUT (presetRecordSize bytes, little endian):
+//  - [0..1]   magic 'P' 'R', an erased slot reads 0xFF 0xFF
+//  - [2]      record format version (presetFormatVersion)
+//  - [3]      payload version, owned by the caller
+//  - [4..7]   sequence number, increases with every save
+//  - [8..27]  payload, zero padded to presetPayloadSize
+//  - [28..31] CRC32 of bytes 0..27
+//
+// Records are appended to the active sector in order, so the newest record is its last non-empty slot.
+// The active sector is the one holding the intact record with the highest sequence, and the other
+// sector is either erased or holds older records (a save or an erase was cut short).
+
+static const uint8_t presetMagic0 = 'P';
+static const uint8_t presetMagic1 = 'R';
+static const size_t presetHeaderSize = 8;
+static const size_t presetCrcOffset = presetHeaderSize + presetPayloadSize;
+static const size_t presetSlots = presetSectorSize / presetRecordSize;
+
+#ifdef ARDUINO
+
+// QSPI flash is memory mapped here for reading
+static const uint32_t qspiMappedBase = 0x90000000;
+
+// Set once the flash is memory mapped, Setup() runs on every effect switch but the flash only needs mapping once
+static bool qspiMapped = false;
+
+// The flash is only switched to indirect mode while writing, and back to memory mapped after
+// Uses the C QSPI driver DaisyDuino carries from libDaisy, every call returns 0 on success
+static bool InitQspi(dsy_qspi_mode mode)
+{
+    static dsy_qspi_handle qspi;
+
+    qspi.device = DSY_QSPI_DEVICE_IS25LP064A;
+    qspi.mode = mode;
+    qspi.pin_config[DSY_QSPI_PIN_IO0] = {DSY_GPIOF, 8};
+    qspi.pin_config[DSY_QSPI_PIN_IO1] = {DSY_GPIOF, 9};
+    qspi.pin_config[DSY_QSPI_PIN_IO2] = {DSY_GPIOF, 7};
+    qspi.pin_config[DSY_QSPI_PIN_IO3] = {DSY_GPIOF, 6};
+    qspi.pin_config[DSY_QSPI_PIN_CLK] = {DSY_GPIOF, 10};
+    qspi.pin_config[DSY_QSPI_PIN_NCS] = {DSY_GPIOG, 6};
+    return (dsy_qspi_init(&qspi) == 0);
+}
+
+// Reads as erased flash if the flash could not be mapped, reading the unmapped region would fault
+static void StorageRead(uint32_t address, uint8_t *data, size_t size)
+{
+    if (!qspiMapped)
+    {
+        memset(data, 0xFF, size);
+        return;
+    }
+    memcpy(data, (const void *)(qspiMappedBase + address), size);
+}
+
+static bool StorageWrite(uint32_t address, const uint8_t *data, size_t size)
+{
+    dsy_qspi_deinit();
+    bool ok = InitQspi(DSY_QSPI_MODE_INDIRECT_POLLING) && (dsy_qspi_write(address, size, (uint8_t *)data) == 0);
+    dsy_qspi_deinit();
+    qspiMapped = InitQspi(DSY_QSPI_MODE_DSY_MEMORY_MAPPED);
+
+    // The mapped region may be cached, drop the stale lines
+    SCB_InvalidateDCache_by_Addr((uint32_t *)(qspiMappedBase + (address & ~31u)), (int32_t)(size + 32));
+    return ok && qspiMapped;
+}
+
+static bool StorageErase(uint32_t address)
+{
+    dsy_qspi_deinit();
+    bool ok = InitQspi(DSY_QSPI_MODE_INDIRECT_POLLING) && (dsy_qspi_erasesector(address) == 0);
+    dsy_qspi_deinit();
+    qspiMapped = InitQspi(DSY_QSPI_MODE_DSY_MEMORY_MAPPED);
+
+    SCB_InvalidateDCache_by_Addr((uint32_t *)(qspiMappedBase + address), (int32_t)presetSectorSize);
+    return ok && qspiMapped;
+}
+
+static void StorageInit()
+{
+    if (!qspiMapped)
+    {
+        qspiMapped = InitQspi(DSY_QSPI_MODE_DSY_MEMORY_MAPPED);
+    }
+}
+
+#else
+
+#include <stdio.h>
+
+// Host stand-in, one file per sector, missing bytes read as erased flash
+static void SectorFileName(uint32_t address, char *name, size_t size)
+{
+    snprintf(name, size, "preset_%08lx.bin", (unsigned long)(address - (address % presetSectorSize)));
+}
+
+static void StorageRead(uint32_t address, uint8_t *data, size_t size)
+{
+    char name[32];
+    SectorFileName(address, name, sizeof(name));
+    memset(data, 0xFF, size);
+
+    FILE *file = fopen(name, "rb");
+    if (file != nullptr)
+    {
+        fseek(file, (long)(address % presetSectorSize), SEEK_SET);
+        size_t got = fread(data, 1, size, file);
+        (void)got;
+        fclose(file);
+    }
+}
+
+static bool StorageWrite(uint32_t address, const uint8_t *data, size_t size)
+{
+    // Programming can only clear bits, same as the NOR flash
+    uint8_t sector[presetSectorSize];
+    uint32_t base = address - (address % presetSectorSize);
+    StorageRead(base, sector, presetSectorSize);
+    for (size_t i = 0; i < size; i++)
+    {
+        sector[(address - base) + i] &= data[i];
+    }
+
+    char name[32];
+    SectorFileName(address, name, sizeof(name));
+    FILE *file = fopen(name, "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    bool ok = (fwrite(sector, 1, presetSectorSize, file) == presetSectorSize);
+    fclose(file);
+    return ok;
+}
+
+static bool StorageErase(uint32_t address)
+{
+    char name[32];
+    SectorFileName(address, name, sizeof(name));
+    remove(name);
+    return true;
+}
+
+static void StorageInit()
+{
+}
+
+#endif
+
+void PresetStore::Init(uint32_t pSectorAddress, uint8_t pPayloadVersion)
+{
+    storeAddress = pSectorAddress - (pSectorAddress % presetSectorSize);
+    payloadVersion = pPayloadVersion;
+    activeSector = 0;
+    nextSlot = 0;
+    sequence = 0;
+
+    StorageInit();
+
+    // The newest intact record, whatever its payload version, picks the active sector and the next sequence
+    bool found = false;
+    uint32_t newest = 0;
+    size_t usedSlots[presetStoreSectors];
+    for (size_t sector = 0; sector < presetStoreSectors; sector++)
+    {
+        for (usedSlots[sector] = 0; usedSlots[sector] < presetSlots; usedSlots[sector]++)
+        {
+            uint8_t record[presetRecordSize];
+            StorageRead(SlotAddress(sector, usedSlots[sector]), record, presetRecordSize);
+
+            if (record[0] == 0xFF && record[1] == 0xFF)
+            {
+                break;
+            }
+
+            if (IsIntactRecord(record) && (!found || RecordSequence(record) >= newest))
+            {
+                found = true;
+                newest = RecordSequence(record);
+                activeSector = sector;
+            }
+        }
+    }
+
+    nextSlot = usedSlots[activeSector];
+    sequence = found ? (newest + 1) : 0;
+}
+
+bool PresetStore::Load(void *payload, size_t size)
+{
+    if (size > presetPayloadSize)
+    {
+        return false;
+    }
+
+    // Newest first through the active sector, then the older records left in the other one
+    for (size_t i = 0; i < presetStoreSectors; i++)
+    {
+        size_t sector = (activeSector + i) % presetStoreSectors;
+        size_t slots = (i == 0) ? nextSlot : presetSlots;
+
+        for (size_t slot = slots; slot > 0; slot--)
+        {
+            uint8_t record[presetRecordSize];
+            StorageRead(SlotAddress(sector, slot - 1), record, presetRecordSize);
+
+            if (IsValidRecord(record))
+            {
+                memcpy(payload, &record[presetHeaderSize], size);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool PresetStore::Save(const void *payload, size_t size)
+{
+    if (size > presetPayloadSize)
+    {
+        return false;
+    }
+
+    // Move to the spare sector once the active one is full, it is normally erased already
+    size_t fullSector = activeSector;
+    bool switched = false;
+    if (nextSlot >= presetSlots)
+    {
+        size_t spare = (activeSector + 1) % presetStoreSectors;
+        if (!IsSectorErased(spare) && !StorageErase(SlotAddress(spare, 0)))
+        {
+            return false;
+        }
+
+        activeSector = spare;
+        nextSlot = 0;
+        switched = true;
+    }
+
+    uint8_t record[presetRecordSize];
+    BuildRecord(record, payload, size, sequence);
+
+    uint32_t address = SlotAddress(activeSector, nextSlot);
+    bool ok = StorageWrite(address, record, presetRecordSize);
+
+    // The slot is used even if the write failed, Load skips it by its CRC
+    nextSlot++;
+    sequence++;
+
+    // Verify the record made it to the flash
+    uint8_t readBack[presetRecordSize];
+    StorageRead(address, readBack, presetRecordSize);
+    ok = ok && (memcmp(record, readBack, presetRecordSize) == 0);
+
+    // The full sector still holds the last good record until the new one is confirmed
+    if (switched && ok)
+    {
+        ok = StorageErase(SlotAddress(fullSector, 0));
+    }
+
+    return ok;
+}
+
+uint16_t PresetStore::Quantize(float value, float minValue, float maxValue)
+{
+    float normalized = (value - minValue) / (maxValue - minValue);
+    if (normalized < 0.0f)
+    {
+        normalized = 0.0f;
+    }
+    else if (normalized > 1.0f)
+    {
+        normalized = 1.0f;
+    }
+
+    return (uint16_t)((normalized * 65535.0f) + 0.5f);
+}
+
+float PresetStore::Dequantize(uint16_t quantized, float minValue, float maxValue)
+{
+    return minValue + (((float)quantized / 65535.0f) * (maxValue - minValue));
+}
+
+void PresetStore::BuildRecord(uint8_t *record, const void *payload, size_t size, uint32_t recordSequence)
+{
+    memset(record, 0, presetRecordSize);
+
+    record[0] = presetMagic0;
+    record[1] = presetMagic1;
+    record[2] = presetFormatVersion;
+    record[3] = payloadVersion;
+    record[4] = (uint8_t)(recordSequence & 0xFF);
+    record[5] = (uint8_t)((recordSequence >> 8) & 0xFF);
+    record[6] = (uint8_t)((recordSequence >> 16) & 0xFF);
+    record[7] = (uint8_t)((recordSequence >> 24) & 0xFF);
+    memcpy(&record[presetHeaderSize], payload, size);
+
+    uint32_t crc = Crc32(record, presetCrcOffset);
+    record[presetCrcOffset] = (uint8_t)(crc & 0xFF);
+    record[presetCrcOffset + 1] = (uint8_t)((crc >> 8) & 0xFF);
+    record[presetCrcOffset + 2] = (uint8_t)((crc >> 16) & 0xFF);
+    record[presetCrcOffset + 3] = (uint8_t)((crc >> 24) & 0xFF);
+}
+
+bool PresetStore::IsValidRecord(const uint8_t *record)
+{
+    return IsIntactRecord(record) && record[3] == payloadVersion;
+}
+
+bool PresetStore::IsIntactRecord(const uint8_t *record)
+{
+    if (record[0] != presetMagic0 || record[1] != presetMagic1 || record[2] != presetFormatVersion)
+    {
+        return false;
+    }
+
+    uint32_t stored = (uint32_t)record[presetCrcOffset] | ((uint32_t)record[presetCrcOffset + 1] << 8) |
+                      ((uint32_t)record[presetCrcOffset + 2] << 16) | ((uint32_t)record[presetCrcOffset + 3] << 24);
+    return stored == Crc32(record, presetCrcOffset);
+}
+
+uint32_t PresetStore::RecordSequence(const uint8_t *record)
+{
+    return (uint32_t)record[4] | ((uint32_t)record[5] << 8) | ((uint32_t)record[6] << 16) | ((uint32_t)record[7] << 24);
+}
+
+bool PresetStore::IsSectorErased(size_t sector)
+{
+    for (size_t slot = 0; slot < presetSlots; slot++)
+    {
+        uint8_t record[presetRecordSize];
+        StorageRead(SlotAddress(sector, slot), record, presetRecordSize);
+
+        for (size_t i = 0; i < presetRecordSize; i++)
+        {
+            if (record[i] != 0xFF)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+uint32_t PresetStore::SlotAddress(size_t sector, size_t slot)
+{
+    return storeAddress + (uint32_t)(sector * presetSectorSize) + (uint32_t)(slot * presetRecordSize);
+}
+
+uint32_t PresetStore::Crc32(const uint8_t *data, size_t size)
+{
+    // Bitwise CRC32 (reflected, 0xEDB88320), only a few records are ever checked so no table is needed
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < size; i++)
+    {
+        crc ^= data[i];
+        for (size_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0u - (crc & 1u)));
+        }
+    }
+
+    return ~crc;
+}
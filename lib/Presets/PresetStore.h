@@ -0,0 +1,85 @@
+#ifndef PRESET_STORE_H
+#define PRESET_STORE_H
+
+#include "DaisyDuino.h"
+#include "../../include/PedalConfig.h"
+
+// QSPI flash geometry (IS25LP064A on the Daisy Seed)
+static const uint32_t presetSectorSize = 4096;
+static const uint32_t presetFlashSize = 8 * 1024 * 1024;
+
+// A store alternates between two sectors so one always holds the last good record
+static const uint32_t presetStoreSectors = 2;
+static const uint32_t presetStoreSize = presetStoreSectors * presetSectorSize;
+
+// Record layout, see PresetStore.cpp
+static const size_t presetRecordSize = 32;
+static const size_t presetPayloadSize = 20;
+static const uint8_t presetFormatVersion = 1;
+
+/**
+ * Stores a small settings payload in two sectors of the QSPI flash
+ *
+ * Every save appends a fixed size record (magic, versions, sequence, payload, CRC32) to the
+ * active sector. Once it is full the next record goes to the start of the spare sector, and the
+ * full sector is only erased after that record reads back, so a power loss at any point leaves
+ * at least one valid record behind. Each sector takes 128 saves per erase.
+ * Loading takes the newest record with a valid CRC and a matching payload version, so a torn
+ * write or a payload from an older firmware falls back to the previous record or to defaults.
+ *
+ * On host builds (no ARDUINO) the sector is a file in the working directory.
+ * Load and Save block on the flash, only call them from Setup or Loop, never from the audio callback.
+ */
+class PresetStore
+{
+public:
+    /**
+     * Initialize the store
+     * @param pSectorAddress Offset of the first of the presetStoreSectors sectors in the QSPI flash, must be sector aligned
+     * @param pPayloadVersion Version of the caller's payload layout, records with another version are ignored
+     */
+    void Init(uint32_t pSectorAddress, uint8_t pPayloadVersion);
+
+    /**
+     * Loads the newest valid payload
+     * @param payload Destination, size bytes
+     * @param size Payload size, up to presetPayloadSize
+     * @return True if a valid record was found, payload is untouched otherwise
+     */
+    bool Load(void *payload, size_t size);
+
+    /**
+     * Appends a new record, moving to the spare sector and erasing the full one if the active sector is full
+     * @return True if the record was written and reads back correctly
+     */
+    bool Save(const void *payload, size_t size);
+
+    /**
+     * Maps a parameter value to the full 16 bit range, min and max may be inverted
+     */
+    static uint16_t Quantize(float value, float minValue, float maxValue);
+
+    /**
+     * Inverse of Quantize
+     */
+    static float Dequantize(uint16_t quantized, float minValue, float maxValue);
+
+private:
+    void BuildRecord(uint8_t *record, const void *payload, size_t size, uint32_t recordSequence);
+    bool IsValidRecord(const uint8_t *record);
+    static bool IsIntactRecord(const uint8_t *record);
+    static uint32_t RecordSequence(const uint8_t *record);
+    bool IsSectorErased(size_t sector);
+    uint32_t SlotAddress(size_t sector, size_t slot);
+    static uint32_t Crc32(const uint8_t *data, size_t size);
+
+    uint32_t storeAddress;
+    uint8_t payloadVersion;
+
+    // Sector the records are appended to, its next free record slot and the sequence number for the next save
+    size_t activeSector;
+    size_t nextSlot;
+    uint32_t sequence;
+};
+
+#endif
@@ -0,0 +1,261 @@
+#ifndef FDN_REVERB_H
+#define FDN_REVERB_H
+
+#include "DaisyDuino.h"
+#include "../../include/PedalConfig.h"
+
+/**
+ * Feedback delay network reverb with numLines delay lines (a power of two) and a Hadamard feedback matrix
+ *
+ * The delay lines use the same read/write scheme as DelayLine (a decrementing write pointer
+ * with reads at write pointer + delay), but all of them are carved out of one contiguous
+ * buffer provided by the caller, so the storage can be placed in SDRAM with a single array.
+ *
+ * Per-line state is kept in plain arrays indexed by line, so the line outputs sit next to each
+ * other and the Hadamard matrix runs as an in-place butterfly over that array (N log N adds,
+ * no gathers), followed by per-line damping and decay over the same contiguous arrays.
+ */
+template <size_t numLines>
+class FdnReverb
+{
+public:
+    /**
+     * Allocates the delay lines out of the pool and clears it
+     * @param pSampleRate Sample rate the reverb runs at
+     * @param pool Buffer shared by all of the delay lines
+     * @param poolSize Number of samples in the pool, the line lengths are scaled down (and kept prime) if it is too small
+     */
+    void Init(float pSampleRate, float *pool, size_t poolSize)
+    {
+        sampleRate = pSampleRate;
+
+        // Line lengths are spread geometrically between the min and max lengths
+        size_t total = 0;
+        for (size_t i = 0; i < numLines; i++)
+        {
+            float ratio = (numLines > 1) ? (float)i / (float)(numLines - 1) : 0.0f;
+            lineLength[i] = (size_t)(fdnMinLineLength * powf(fdnMaxLineLength / fdnMinLineLength, ratio));
+            total += lineLength[i];
+        }
+
+        // Scale them down to fit the pool, then round them to primes, which keeps the echo densities from lining up
+        float scale = (total > poolSize) ? (float)poolSize / (float)total : 1.0f;
+        for (size_t i = 0; i < numLines; i++)
+        {
+            lineLength[i] = (size_t)(lineLength[i] * scale);
+        }
+        RoundDownToPrimes(lineLength);
+
+        size_t offset = 0;
+        for (size_t i = 0; i < numLines; i++)
+        {
+            lines[i] = &pool[offset];
+            offset += lineLength[i];
+            writeIndex[i] = 0;
+            delay[i] = lineLength[i] - 1;
+            dampState[i] = 0.0f;
+
+            // Alternate the input and output signs to decorrelate the lines
+            inputGain[i] = (i & 1) ? -1.0f : 1.0f;
+            outputGain[i] = (i & 2) ? -1.0f : 1.0f;
+        }
+
+        for (size_t i = 0; i < offset; i++)
+        {
+            pool[i] = 0.0f;
+        }
+
+        SetSize(1.0f);
+        SetDamping(sampleRate / 2.0f);
+        SetDecayTime(2.0f);
+    }
+
+    /**
+     * Clears the delay lines and the damping filters
+     */
+    void Reset()
+    {
+        for (size_t i = 0; i < numLines; i++)
+        {
+            for (size_t s = 0; s < lineLength[i]; s++)
+            {
+                lines[i][s] = 0.0f;
+            }
+            dampState[i] = 0.0f;
+        }
+    }
+
+    /**
+     * Sets the time it takes the tail to decay by 60dB
+     */
+    void SetDecayTime(float seconds)
+    {
+        decayTime = seconds;
+        UpdateFeedback();
+    }
+
+    /**
+     * Sets the cutoff of the lowpass in each feedback path
+     */
+    void SetDamping(float freq)
+    {
+        if (freq > sampleRate / 2.0f)
+        {
+            freq = sampleRate / 2.0f;
+        }
+        dampCoeff = 1.0f - expf(-2.0f * PI_VAL * freq / sampleRate);
+    }
+
+    /**
+     * Sets the room size as a fraction (0 - 1) of the allocated line lengths
+     * The loop lengths are rounded down to primes at every size, so the lines stay mutually prime
+     */
+    void SetSize(float size)
+    {
+        if (size < fdnMinSize)
+        {
+            size = fdnMinSize;
+        }
+        else if (size > 1.0f)
+        {
+            size = 1.0f;
+        }
+
+        // A line's loop is its delay plus the sample it is written back in
+        size_t loopLength[numLines];
+        for (size_t i = 0; i < numLines; i++)
+        {
+            loopLength[i] = (size_t)((float)lineLength[i] * size);
+        }
+        RoundDownToPrimes(loopLength);
+
+        for (size_t i = 0; i < numLines; i++)
+        {
+            delay[i] = loopLength[i] - 1;
+        }
+        UpdateFeedback();
+    }
+
+    /**
+     * Processes a single sample and returns the reverb tail
+     */
+    inline float Process(float in)
+    {
+        float state[numLines];
+        float out = 0.0f;
+
+        // Read the line outputs into a contiguous state vector and tap the output
+        for (size_t i = 0; i < numLines; i++)
+        {
+            size_t readIndex = writeIndex[i] + delay[i];
+            if (readIndex >= lineLength[i])
+            {
+                readIndex -= lineLength[i];
+            }
+            state[i] = lines[i][readIndex];
+            out += outputGain[i] * state[i];
+        }
+
+        // Hadamard mixing as an in-place butterfly
+        for (size_t half = 1; half < numLines; half *= 2)
+        {
+            for (size_t i = 0; i < numLines; i += half * 2)
+            {
+                for (size_t j = i; j < i + half; j++)
+                {
+                    float a = state[j];
+                    float b = state[j + half];
+                    state[j] = a + b;
+                    state[j + half] = a - b;
+                }
+            }
+        }
+
+        // Damp, decay and write back along with the input
+        for (size_t i = 0; i < numLines; i++)
+        {
+            dampState[i] += dampCoeff * ((state[i] * matrixScale) - dampState[i]);
+            writeIndex[i] = (writeIndex[i] == 0) ? (lineLength[i] - 1) : (writeIndex[i] - 1);
+            lines[i][writeIndex[i]] = (dampState[i] * feedback[i]) + (in * inputGain[i]);
+        }
+
+        return out * matrixScale;
+    }
+
+private:
+    // Line length range in samples (~15ms to ~50ms at 96kHz)
+    static constexpr float fdnMinLineLength = 1499.0f;
+    static constexpr float fdnMaxLineLength = 4801.0f;
+    static constexpr float fdnMinSize = 0.1f;
+
+    // Scales the Hadamard matrix to be orthogonal (1 / sqrt(numLines))
+    const float matrixScale = 1.0f / sqrtf((float)numLines);
+
+    /**
+     * Recalculates the per-line feedback so every line decays at the same rate regardless of its length
+     */
+    void UpdateFeedback()
+    {
+        for (size_t i = 0; i < numLines; i++)
+        {
+            feedback[i] = powf(10.0f, -3.0f * (float)(delay[i] + 1) / (decayTime * sampleRate));
+        }
+    }
+
+    /**
+     * Rounds ascending lengths down to distinct primes, which are then mutually prime
+     * The longest is rounded first and every shorter one is kept below it
+     */
+    static void RoundDownToPrimes(size_t *lengths)
+    {
+        size_t limit = lengths[numLines - 1];
+        for (size_t i = numLines; i-- > 0;)
+        {
+            lengths[i] = PreviousPrime((lengths[i] < limit) ? lengths[i] : limit);
+            limit = lengths[i] - 1;
+        }
+    }
+
+    /**
+     * @return Largest prime no greater than n, or 2 when there is none
+     */
+    static size_t PreviousPrime(size_t n)
+    {
+        while (n > 2)
+        {
+            bool prime = true;
+            for (size_t d = 2; d * d <= n; d++)
+            {
+                if (n % d == 0)
+                {
+                    prime = false;
+                    break;
+                }
+            }
+            if (prime)
+            {
+                return n;
+            }
+            n--;
+        }
+        return 2;
+    }
+
+    float sampleRate;
+
+    // Delay lines carved from the pool
+    float *lines[numLines];
+    size_t lineLength[numLines];
+    size_t writeIndex[numLines];
+    size_t delay[numLines];
+
+    // Per-line parameters and state
+    float inputGain[numLines];
+    float outputGain[numLines];
+    float feedback[numLines];
+    float dampState[numLines];
+    float dampCoeff = 1.0f;
+    float decayTime = 2.0f;
+};
+
+#endif
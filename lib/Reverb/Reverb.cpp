@@ -0,0 +1,94 @@
+#include "Reverb.h"
+
+// Storage for all of the delay lines, shared by the FDN
+static float DSY_SDRAM_BSS reverbPool[reverbPoolSize];
+
+// Initialize the reverb
+void Reverb::Setup(size_t pNumChannels)
+{
+    // Allocate the delay lines
+    fdn.Init(sampleRateHz, reverbPool, reverbPoolSize);
+
+    // Initialize the level
+    level.Init(reverbLevelKnobPin, INPUT, levelValue, minReverbLevelValue, maxReverbLevelValue);
+
+    // Initialize the decay
+    decay.Init(reverbDecayKnobPin, INPUT, decayValue, minReverbDecayValue, maxReverbDecayValue);
+    fdn.SetDecayTime(decayValue);
+
+    // Initialize the damping
+    damping.Init(reverbDampingKnobPin, INPUT, dampingValue, minReverbDampingValue, maxReverbDampingValue);
+    fdn.SetDamping(dampingValue);
+
+    // Initialize the size
+    roomSize.Init(reverbSizeKnobPin, INPUT, sizeValue, minReverbSizeValue, maxReverbSizeValue);
+    fdn.SetSize(sizeValue);
+}
+
+// Clean up the reverb
+void Reverb::Cleanup()
+{
+    fdn.Reset();
+}
+
+// Audio callback when audio input occurs
+ITCM_FUNC void Reverb::AudioCallback(float **in, float **out, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        float dry, wet;
+
+        // Read Dry from I/O
+        dry = in[AUDIO_IN_CH][i];
+
+        // Run the reverb
+        wet = fdn.Process(dry);
+
+        // Mix Dry and Wet and send to I/O
+        out[AUDIO_OUT_CH][i] = ((wet * levelValue) + dry);
+    }
+}
+
+// Logic for the reverb to add into the main loop
+void Reverb::Loop()
+{
+    // Update the level if the knob has been moved
+    if (level.SetNewValue(levelValue))
+    {
+        debugPrint("Updated the level to: ");
+        debugPrintln(levelValue);
+    }
+
+    // Update the decay if the knob has been moved
+    if (decay.SetNewValue(decayValue))
+    {
+        fdn.SetDecayTime(decayValue);
+
+        debugPrint("Updated the decay to: ");
+        debugPrintln(decayValue);
+    }
+
+    // Update the damping if the knob has been moved
+    if (damping.SetNewValue(dampingValue))
+    {
+        fdn.SetDamping(dampingValue);
+
+        debugPrint("Updated the damping to: ");
+        debugPrintln(dampingValue);
+    }
+
+    // Update the size if the knob has been moved
+    if (roomSize.SetNewValue(sizeValue))
+    {
+        fdn.SetSize(sizeValue);
+
+        debugPrint("Updated the size to: ");
+        debugPrintln(sizeValue);
+    }
+}
+
+// Return the effect name (for debugging)
+String Reverb::GetEffectName()
+{
+    return "Reverb";
+}
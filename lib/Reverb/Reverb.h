@@ -0,0 +1,85 @@
+#ifndef REVERB_H
+#define REVERB_H
+
+#include "DaisyDuino.h"
+#include "../../include/IEffect.h"
+#include "../../include/PedalConfig.h"
+#include "../Inputs/Knob.h"
+#include "FdnReverb.h"
+#include "../Utility/MemoryPlacement.h"
+
+/**********************************************
+ * Reverb Effect
+ * 
+ * SPST 1 - N/U
+ * SPST 2 - N/U
+ * SPST 3 - N/U
+ * SPST 4 - N/U
+ * 
+ * SPDT 1 - N/U
+ * SPDT 2 - N/U
+ * 
+ * Knob 1 - Effect Level
+ * Knob 2 - Decay
+ * Knob 3 - Damping
+ * Knob 4 - Size
+ * 
+ * LED 1 - N/U
+ * LED 2 - N/U
+ * LED 3 - N/U
+ * LED 4 - N/U
+ **********************************************/
+
+// Pin renaming
+static const int reverbLevelKnobPin = effectPotPin4;
+static const int reverbDecayKnobPin = effectPotPin2;
+static const int reverbDampingKnobPin = effectPotPin3;
+static const int reverbSizeKnobPin = effectPotPin1;
+
+// Constant parameters
+static const size_t reverbLines = 8;
+static const size_t reverbPoolSize = 65536;
+
+// Level constants
+static const float minReverbLevelValue = 1.0f;
+static const float maxReverbLevelValue = 0.0f;
+
+// Decay constants (RT60 in seconds)
+static const float minReverbDecayValue = 8.0f;
+static const float maxReverbDecayValue = 0.3f;
+
+// Damping constants (cutoff in Hz)
+static const float minReverbDampingValue = 1500.0f;
+static const float maxReverbDampingValue = 18000.0f;
+
+// Size constants (fraction of the allocated line lengths)
+static const float minReverbSizeValue = 1.0f;
+static const float maxReverbSizeValue = 0.2f;
+
+class Reverb : public IEffect
+{
+public:
+    void Setup(size_t pNumChannels);
+    void Cleanup();
+    void AudioCallback(float **in, float **out, size_t size);
+    void Loop();
+    String GetEffectName();
+
+private:
+    // Input handlers
+    Knob level;
+    Knob decay;
+    Knob damping;
+    Knob roomSize;
+
+    // Mutable parameters
+    float levelValue = 0.5f;
+    float decayValue = 2.0f;
+    float dampingValue = maxReverbDampingValue;
+    float sizeValue = 1.0f;
+
+    // Reverb engine
+    FdnReverb<reverbLines> fdn;
+};
+
+#endif
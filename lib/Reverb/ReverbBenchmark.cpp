@@ -0,0 +1,41 @@
+#include "ReverbBenchmark.h"
+
+static const size_t benchPoolSize = 65536;
+static const size_t benchSamples = 4800;
+
+static float DSY_SDRAM_BSS benchPool[benchPoolSize];
+
+// Time one FDN size, one sample at a time the way the audio callback runs it
+template <size_t numLines>
+static void BenchmarkFdn()
+{
+    CycleCounter counter;
+    FdnReverb<numLines> fdn;
+
+    fdn.Init(sampleRateHz, benchPool, benchPoolSize);
+
+    for (size_t i = 0; i < benchSamples; i++)
+    {
+        float in = ((float)random(-1000, 1000)) / 1000.0f;
+        counter.Start();
+        fdn.Process(in);
+        counter.Stop(1);
+    }
+
+    debugPrint("FDN ");
+    debugPrint(numLines);
+    debugPrint(" lines: ");
+    debugPrintF(counter.CyclesPerSample(), 1);
+    debugPrint(" cycles/sample, worst ");
+    debugPrint(counter.MaxCycles());
+    debugPrintln(" cycles");
+}
+
+void RunReverbBenchmark()
+{
+    debugPrintln("Reverb benchmark:");
+
+    BenchmarkFdn<4>();
+    BenchmarkFdn<8>();
+    BenchmarkFdn<16>();
+}
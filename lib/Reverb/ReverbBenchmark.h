@@ -0,0 +1,14 @@
+#ifndef REVERB_BENCHMARK_H
+#define REVERB_BENCHMARK_H
+
+#include "DaisyDuino.h"
+#include "../../include/PedalConfig.h"
+#include "../Utility/CycleCounter.h"
+#include "FdnReverb.h"
+
+/**
+ * Prints the cost of the FDN reverb in cycles per sample for 4, 8 and 16 delay lines
+ */
+void RunReverbBenchmark();
+
+#endif
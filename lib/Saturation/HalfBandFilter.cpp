@@ -0,0 +1,92 @@
+#include "HalfBandFilter.h"
+
+// With halfBandTaps = 2M the full filter has 4M - 1 taps and the center tap sits at 2M - 1.
+// The non-zero taps are at even indices 0, 2, ... 4M - 2, which is the phase that gets convolved,
+// while the odd phase only sees the center tap and reduces to a delay of M - 1 (up) or M (down) samples.
+
+void HalfBandFilter::Init()
+{
+    const size_t fullLength = (halfBandTaps * 2) - 1;
+    const float center = (float)(fullLength - 1) / 2.0f;
+
+    // Windowed sinc with a Blackman window, cutoff at a quarter of the oversampled rate
+    for (size_t k = 0; k < halfBandTaps / 2; k++)
+    {
+        float n = (float)(k * 2) - center;
+        float sinc = sinf(PI_VAL * n / 2.0f) / (PI_VAL * n);
+        float phase = 2.0f * PI_VAL * (float)(k * 2) / (float)(fullLength - 1);
+        float window = 0.42f - (0.5f * cosf(phase)) + (0.08f * cosf(2.0f * phase));
+        coeffs[k] = sinc * window;
+    }
+
+    // Normalize so the even phase sums to 0.5, matching the center tap, for unity gain at DC
+    float sum = 0.0f;
+    for (size_t k = 0; k < halfBandTaps / 2; k++)
+    {
+        sum += coeffs[k] * 2.0f;
+    }
+    for (size_t k = 0; k < halfBandTaps / 2; k++)
+    {
+        coeffs[k] *= 0.5f / sum;
+    }
+
+    Reset();
+}
+
+void HalfBandFilter::Reset()
+{
+    for (size_t i = 0; i < halfBandTaps * 2; i++)
+    {
+        upHistory[i] = 0.0f;
+        downHistory[i] = 0.0f;
+    }
+    for (size_t i = 0; i < halfBandTaps / 2; i++)
+    {
+        downDelay[i] = 0.0f;
+    }
+
+    upIndex = 0;
+    downIndex = 0;
+    downDelayIndex = 0;
+}
+
+ITCM_FUNC void HalfBandFilter::Upsample(float in, float *out)
+{
+    Push(upHistory, upIndex, in);
+
+    // Even phase is the convolution (gain of 2 to make up for the inserted zeros), odd phase is the delayed input
+    out[0] = 2.0f * Convolve(&upHistory[upIndex]);
+    out[1] = upHistory[upIndex + (halfBandTaps / 2) - 1];
+}
+
+ITCM_FUNC float HalfBandFilter::Downsample(const float *in)
+{
+    // Delay the odd phase by M samples, the oldest entry is the one being overwritten
+    float delayed = downDelay[downDelayIndex];
+    downDelay[downDelayIndex] = in[1];
+    downDelayIndex++;
+    if (downDelayIndex >= halfBandTaps / 2)
+    {
+        downDelayIndex = 0;
+    }
+
+    Push(downHistory, downIndex, in[0]);
+
+    return Convolve(&downHistory[downIndex]) + (0.5f * delayed);
+}
+
+void HalfBandFilter::UpsampleBlock(const float *in, float *out, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        Upsample(in[i], &out[i * 2]);
+    }
+}
+
+void HalfBandFilter::DownsampleBlock(const float *in, float *out, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        out[i] = Downsample(&in[i * 2]);
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef HALF_BAND_FILTER_H
+#define HALF_BAND_FILTER_H
+
+#include "DaisyDuino.h"
+#include "../../include/PedalConfig.h"
+#include "../Utility/MemoryPlacement.h"
+
+// Number of non-zero taps (excluding the center tap) in the half-band filter, must be even
+static const size_t halfBandTaps = 16;
+
+/**
+ * Polyphase half-band FIR used for 2x up and down sampling
+ * Every other coefficient of a half-band filter is zero and the center tap is 0.5,
+ * so each phase only runs the non-zero taps (folded, since they are symmetric)
+ * and the other phase is a plain delay
+ */
+class HalfBandFilter
+{
+public:
+    /**
+     * Calculates the windowed sinc coefficients and clears the history
+     */
+    void Init();
+
+    /**
+     * Clears the filter history
+     */
+    void Reset();
+
+    /**
+     * Upsamples a single sample into two output samples
+     */
+    void Upsample(float in, float *out);
+
+    /**
+     * Downsamples two input samples into a single output sample
+     */
+    float Downsample(const float *in);
+
+    /**
+     * Block versions, out must hold size * 2 samples for Upsample and in must hold size * 2 samples for Downsample
+     */
+    void UpsampleBlock(const float *in, float *out, size_t size);
+    void DownsampleBlock(const float *in, float *out, size_t size);
+
+private:
+    /**
+     * Adds a sample to a history buffer, the buffer is written twice so the taps can always be read contiguously
+     */
+    inline void Push(float *history, size_t &index, float in)
+    {
+        index = (index == 0) ? (halfBandTaps - 1) : (index - 1);
+        history[index] = in;
+        history[index + halfBandTaps] = in;
+    }
+
+    /**
+     * Runs the folded non-zero taps over a contiguous history window (newest sample first)
+     */
+    inline float Convolve(const float *window)
+    {
+        float acc = 0.0f;
+        for (size_t k = 0; k < halfBandTaps / 2; k++)
+        {
+            acc += coeffs[k] * (window[k] + window[halfBandTaps - 1 - k]);
+        }
+        return acc;
+    }
+
+    // Non-zero taps, only the first half is stored since the filter is symmetric
+    float coeffs[halfBandTaps / 2];
+
+    // Upsampler history
+    float upHistory[halfBandTaps * 2];
+    size_t upIndex = 0;
+
+    // Downsampler histories, one for each input phase
+    float downHistory[halfBandTaps * 2];
+    size_t downIndex = 0;
+    float downDelay[halfBandTaps / 2];
+    size_t downDelayIndex = 0;
+};
+
+#endif
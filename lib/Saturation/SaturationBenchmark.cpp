@@ -0,0 +1,78 @@
+#include "SaturationBenchmark.h"
+
+static const size_t benchBlockSize = 4800;
+
+// A 15kHz tone at 96kHz has its 5th and 7th harmonics fold back to 21kHz and 9kHz
+static const float benchToneFreq = 15000.0f;
+static const float benchAliasFreq1 = 21000.0f;
+static const float benchAliasFreq2 = 9000.0f;
+static const float benchDrive = 8.0f;
+
+static float benchIn[benchBlockSize];
+static float benchOut[benchBlockSize];
+
+// Returns the magnitude of a single frequency in the buffer using the Goertzel algorithm
+static float Goertzel(const float *buffer, size_t size, float freq)
+{
+    float coeff = 2.0f * cosf(2.0f * PI_VAL * freq / sampleRateHz);
+    float s1 = 0.0f;
+    float s2 = 0.0f;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        float s0 = buffer[i] + (coeff * s1) - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+
+    return sqrtf((s1 * s1) + (s2 * s2) - (coeff * s1 * s2));
+}
+
+void RunSaturationBenchmark()
+{
+    const size_t factors[] = {1, 2, 4};
+    const ShaperType types[] = {SHAPER_TANH, SHAPER_SOFT_CLIP, SHAPER_HARD_CLIP};
+    const char *typeNames[] = {"Tanh", "SoftClip", "HardClip"};
+
+    CycleCounter counter;
+    Saturator saturator;
+
+    // Generate an exact number of cycles of the test tone so the Goertzel bins line up
+    for (size_t i = 0; i < benchBlockSize; i++)
+    {
+        benchIn[i] = 0.5f * sinf(2.0f * PI_VAL * benchToneFreq * (float)i / sampleRateHz);
+    }
+
+    debugPrintln("Saturation benchmark:");
+
+    for (size_t t = 0; t < 3; t++)
+    {
+        for (size_t f = 0; f < 3; f++)
+        {
+            saturator.Init(factors[f], types[t]);
+            saturator.SetDrive(benchDrive);
+
+            // Let the filters settle, then measure
+            saturator.ProcessBlock(benchIn, benchOut, benchBlockSize);
+            counter.Reset();
+            counter.Start();
+            saturator.ProcessBlock(benchIn, benchOut, benchBlockSize);
+            counter.Stop(benchBlockSize);
+
+            // Alias level relative to the fundamental
+            float fundamental = Goertzel(benchOut, benchBlockSize, benchToneFreq);
+            float alias1 = Goertzel(benchOut, benchBlockSize, benchAliasFreq1);
+            float alias2 = Goertzel(benchOut, benchBlockSize, benchAliasFreq2);
+            float aliasDb = 20.0f * log10f((alias1 > alias2 ? alias1 : alias2) / fundamental + 1e-9f);
+
+            debugPrint(typeNames[t]);
+            debugPrint(" ");
+            debugPrint(factors[f]);
+            debugPrint("x: ");
+            debugPrintF(counter.CyclesPerSample(), 2);
+            debugPrint(" cycles/sample, alias ");
+            debugPrintF(aliasDb, 1);
+            debugPrintln(" dB");
+        }
+    }
+}
@@ -0,0 +1,15 @@
+#ifndef SATURATION_BENCHMARK_H
+#define SATURATION_BENCHMARK_H
+
+#include "DaisyDuino.h"
+#include "../../include/PedalConfig.h"
+#include "../Utility/CycleCounter.h"
+#include "Saturator.h"
+
+/**
+ * Runs each waveshaper at every oversampling factor and prints the cost in cycles per sample
+ * along with the level of the strongest aliases of a driven high frequency sine
+ */
+void RunSaturationBenchmark();
+
+#endif
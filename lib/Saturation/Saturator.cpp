@@ -0,0 +1,97 @@
+#include "Saturator.h"
+
+void Saturator::Init(size_t pOversampling, ShaperType pType)
+{
+    // Only 1x, 2x and 4x are supported, anything else falls back to 2x
+    if (pOversampling == 1 || pOversampling == 4)
+    {
+        oversampling = pOversampling;
+    }
+    else
+    {
+        oversampling = 2;
+    }
+
+    type = pType;
+    drive = 1.0f;
+
+    outerUp.Init();
+    outerDown.Init();
+    innerUp.Init();
+    innerDown.Init();
+}
+
+void Saturator::Reset()
+{
+    outerUp.Reset();
+    outerDown.Reset();
+    innerUp.Reset();
+    innerDown.Reset();
+}
+
+void Saturator::SetDrive(float pDrive)
+{
+    drive = pDrive;
+}
+
+void Saturator::SetType(ShaperType pType)
+{
+    type = pType;
+}
+
+ITCM_FUNC float Saturator::Process(float in)
+{
+    float up2[2];
+    float up4[4];
+
+    in *= drive;
+
+    switch (oversampling)
+    {
+    case 1:
+        return Waveshaper::Process(type, in);
+
+    case 4:
+        // Up to 4x, shape, then back down through both stages
+        outerUp.Upsample(in, up2);
+        innerUp.Upsample(up2[0], &up4[0]);
+        innerUp.Upsample(up2[1], &up4[2]);
+        for (size_t i = 0; i < 4; i++)
+        {
+            up4[i] = Waveshaper::Process(type, up4[i]);
+        }
+        up2[0] = innerDown.Downsample(&up4[0]);
+        up2[1] = innerDown.Downsample(&up4[2]);
+        return outerDown.Downsample(up2);
+
+    case 2:
+    default:
+        outerUp.Upsample(in, up2);
+        up2[0] = Waveshaper::Process(type, up2[0]);
+        up2[1] = Waveshaper::Process(type, up2[1]);
+        return outerDown.Downsample(up2);
+    }
+}
+
+void Saturator::ProcessBlock(const float *in, float *out, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        out[i] = Process(in[i]);
+    }
+}
+
+size_t Saturator::GetLatency()
+{
+    // Each up/down pair delays by (halfBandTaps - 1) samples at the rate below it
+    switch (oversampling)
+    {
+    case 1:
+        return 0;
+    case 4:
+        return (halfBandTaps - 1) + ((halfBandTaps - 1) / 2);
+    case 2:
+    default:
+        return halfBandTaps - 1;
+    }
+}
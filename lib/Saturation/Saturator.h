@@ -0,0 +1,69 @@
+#ifndef SATURATOR_H
+#define SATURATOR_H
+
+#include "DaisyDuino.h"
+#include "../../include/PedalConfig.h"
+#include "HalfBandFilter.h"
+#include "Waveshaper.h"
+#include "../Utility/MemoryPlacement.h"
+
+// Largest supported oversampling factor
+static const size_t maxOversampling = 4;
+
+/**
+ * Drive stage that runs a waveshaper at 1x, 2x or 4x the sample rate
+ * 4x is two cascaded half-band stages, so the cost roughly doubles from 2x to 4x
+ */
+class Saturator
+{
+public:
+    /**
+     * Initialize the saturator
+     * @param pOversampling Oversampling factor, either 1, 2 or 4
+     * @param pType Waveshaping curve to use
+     */
+    void Init(size_t pOversampling, ShaperType pType);
+
+    /**
+     * Clears the oversampling filters
+     */
+    void Reset();
+
+    /**
+     * Sets the gain applied before the waveshaper
+     */
+    void SetDrive(float pDrive);
+
+    /**
+     * Sets the waveshaping curve
+     */
+    void SetType(ShaperType pType);
+
+    /**
+     * Processes a single sample through the oversampled waveshaper
+     */
+    float Process(float in);
+
+    /**
+     * Processes a block of samples, in and out may be the same buffer
+     */
+    void ProcessBlock(const float *in, float *out, size_t size);
+
+    /**
+     * @return Latency added by the oversampling filters, in samples at the base rate
+     */
+    size_t GetLatency();
+
+private:
+    size_t oversampling = 1;
+    ShaperType type = SHAPER_TANH;
+    float drive = 1.0f;
+
+    // Outer stage converts between 1x and 2x, inner stage between 2x and 4x
+    HalfBandFilter outerUp;
+    HalfBandFilter outerDown;
+    HalfBandFilter innerUp;
+    HalfBandFilter innerDown;
+};
+
+#endif
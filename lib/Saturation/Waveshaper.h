@@ -0,0 +1,90 @@
+#ifndef WAVESHAPER_H
+#define WAVESHAPER_H
+
+#include "DaisyDuino.h"
+
+/**
+ * Available waveshaping curves, all of them are bounded to +/-1
+ */
+enum ShaperType
+{
+    SHAPER_TANH = 0,
+    SHAPER_SOFT_CLIP = 1,
+    SHAPER_HARD_CLIP = 2
+};
+
+/**
+ * Static waveshaping curves
+ * These generate harmonics past Nyquist, so they should be run inside an Oversampler
+ */
+namespace Waveshaper
+{
+    /**
+     * Rational approximation of tanh, accurate to ~2% and exactly +/-1 past +/-3
+     */
+    inline float Tanh(float x)
+    {
+        if (x > 3.0f)
+        {
+            return 1.0f;
+        }
+        else if (x < -3.0f)
+        {
+            return -1.0f;
+        }
+
+        float x2 = x * x;
+        return x * (27.0f + x2) / (27.0f + (9.0f * x2));
+    }
+
+    /**
+     * Linear up to 0.5, then a smooth knee approaching +/-1
+     */
+    inline float SoftClip(float x)
+    {
+        float mag = fabsf(x);
+        if (mag <= 0.5f)
+        {
+            return x;
+        }
+
+        float over = (mag - 0.5f) * 2.0f;
+        float shaped = 0.5f + (0.5f * over / (1.0f + over));
+        return (x > 0.0f) ? shaped : -shaped;
+    }
+
+    /**
+     * Clamps to +/-1
+     */
+    inline float HardClip(float x)
+    {
+        if (x > 1.0f)
+        {
+            return 1.0f;
+        }
+        else if (x < -1.0f)
+        {
+            return -1.0f;
+        }
+        return x;
+    }
+
+    /**
+     * Runs the selected curve
+     */
+    inline float Process(ShaperType type, float x)
+    {
+        switch (type)
+        {
+        case SHAPER_SOFT_CLIP:
+            return SoftClip(x);
+        case SHAPER_HARD_CLIP:
+            return HardClip(x);
+        case SHAPER_TANH:
+        default:
+            return Tanh(x);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,144 @@
+#include "DecimatedDelayLine.h"
+
+void DecimatedDelayLine::Init(float *pBuffer, size_t pSize, size_t pFactor)
+{
+    buffer = pBuffer;
+    size = pSize;
+    factor = (pFactor == 4) ? 4 : 2;
+
+    outerDown.Init();
+    innerDown.Init();
+    innerUp.Init();
+    outerUp.Init();
+
+    Reset();
+}
+
+void DecimatedDelayLine::Reset()
+{
+    outerDown.Reset();
+    innerDown.Reset();
+    innerUp.Reset();
+    outerUp.Reset();
+
+    for (size_t i = 0; i < 4; i++)
+    {
+        interpolated[i] = 0.0f;
+    }
+
+    writePtr = 0;
+    written = 0;
+    readPhase = 0;
+    writePhase = 0;
+}
+
+void DecimatedDelayLine::SetDelay(size_t pDelay)
+{
+    // Round trip latency of the half-band stages, in full rate samples
+    size_t latency = (halfBandTaps - 1) * 2;
+    if (factor == 4)
+    {
+        latency += (halfBandTaps - 1) * 4;
+    }
+
+    // Convert to decimated samples, keeping at least one sample of delay
+    size_t decimated = (pDelay > latency) ? ((pDelay - latency + (factor / 2)) / factor) : 0;
+    if (decimated < 1)
+    {
+        decimated = 1;
+    }
+    else if (decimated > size - 1)
+    {
+        decimated = size - 1;
+    }
+
+    delay = decimated;
+}
+
+size_t DecimatedDelayLine::GetMaxDelay()
+{
+    return (size - 1) * factor;
+}
+
+ITCM_FUNC float DecimatedDelayLine::Read()
+{
+    // Interpolate a new decimated sample at the start of each period
+    if (readPhase == 0)
+    {
+        size_t readPtr = writePtr + delay;
+        if (readPtr >= size)
+        {
+            readPtr -= size;
+        }
+        float stored = (delay <= written) ? buffer[readPtr] : 0.0f;
+
+        if (factor == 4)
+        {
+            float half[2];
+            innerUp.Upsample(stored, half);
+            outerUp.Upsample(half[0], &interpolated[0]);
+            outerUp.Upsample(half[1], &interpolated[2]);
+        }
+        else
+        {
+            outerUp.Upsample(stored, interpolated);
+        }
+    }
+
+    float out = interpolated[readPhase];
+
+    readPhase++;
+    if (readPhase == factor)
+    {
+        readPhase = 0;
+    }
+
+    return out;
+}
+
+ITCM_FUNC void DecimatedDelayLine::Write(float in)
+{
+    bool stored = false;
+    float decimated = 0.0f;
+
+    // Full rate to half rate
+    outerDownInput[writePhase & 1] = in;
+    if (writePhase & 1)
+    {
+        float half = outerDown.Downsample(outerDownInput);
+
+        if (factor == 4)
+        {
+            // Half rate to quarter rate
+            innerDownInput[(writePhase >> 1) & 1] = half;
+            if (writePhase == 3)
+            {
+                decimated = innerDown.Downsample(innerDownInput);
+                stored = true;
+            }
+        }
+        else
+        {
+            decimated = half;
+            stored = true;
+        }
+    }
+
+    writePhase++;
+    if (writePhase == factor)
+    {
+        writePhase = 0;
+    }
+
+    // Same pointer movement as DelayLine, the newest sample is at writePtr
+    if (stored)
+    {
+        buffer[writePtr] = decimated;
+        writePtr = (writePtr == 0) ? (size - 1) : (writePtr - 1);
+
+        if (written < size)
+        {
+            written++;
+        }
+    }
+}
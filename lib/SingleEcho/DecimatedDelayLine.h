@@ -0,0 +1,85 @@
+#ifndef DECIMATED_DELAY_LINE_H
+#define DECIMATED_DELAY_LINE_H
+
+#include "DaisyDuino.h"
+#include "../../include/PedalConfig.h"
+#include "../Saturation/HalfBandFilter.h"
+#include "../Utility/MemoryPlacement.h"
+
+/**
+ * Delay line that stores the signal at 1/2 or 1/4 of the sample rate
+ *
+ * Writes are lowpassed and decimated through half-band stages before they reach the buffer,
+ * and reads are interpolated back up through matching stages, so the same buffer holds 2x or
+ * 4x the delay time and the buffer is only touched once every 2 or 4 samples. Everything above
+ * a quarter (2x) or an eighth (4x) of the sample rate is removed from the repeats.
+ *
+ * The buffer is provided by the caller so it can live in SDRAM. The interface follows DelayLine:
+ * Read() then Write() once per sample, with delays given in full rate samples.
+ * The buffer is never cleared, reads past the number of samples written since the last reset
+ * return silence (same as LazyDelayLine).
+ */
+class DecimatedDelayLine
+{
+public:
+    /**
+     * Initialize the delay line, the buffer contents are ignored until overwritten
+     * @param pBuffer Storage for the decimated samples
+     * @param pSize Number of decimated samples in the buffer
+     * @param pFactor Decimation factor, either 2 or 4
+     */
+    void Init(float *pBuffer, size_t pSize, size_t pFactor);
+
+    /**
+     * Forgets the buffer contents and clears the filters
+     */
+    void Reset();
+
+    /**
+     * Sets the delay in full rate samples, rounded to the decimation factor
+     * The filter latency is taken out so the echo lands where a full rate delay would put it
+     */
+    void SetDelay(size_t delay);
+
+    /**
+     * @return Longest delay in full rate samples
+     */
+    size_t GetMaxDelay();
+
+    /**
+     * Reads the next full rate output sample
+     */
+    float Read();
+
+    /**
+     * Writes the next full rate input sample
+     */
+    void Write(float in);
+
+private:
+    float *buffer = nullptr;
+    size_t size = 0;
+    size_t factor = 2;
+    size_t writePtr = 0;
+    size_t delay = 1;
+
+    // Decimated samples written since the last reset, reads past this return silence
+    size_t written = 0;
+
+    // Full rate sample counters within one decimated sample period
+    size_t readPhase = 0;
+    size_t writePhase = 0;
+
+    // Decimator, outer stage is full rate to 1/2, inner stage is 1/2 to 1/4
+    HalfBandFilter outerDown;
+    HalfBandFilter innerDown;
+    float outerDownInput[2];
+    float innerDownInput[2];
+
+    // Interpolator
+    HalfBandFilter innerUp;
+    HalfBandFilter outerUp;
+    float interpolated[4];
+};
+
+#endif
@@ -0,0 +1,100 @@
+#include "DelayBenchmark.h"
+
+static const size_t benchDelaySize = 96000;
+static const size_t benchDelay = 4800;
+static const size_t benchSamples = 9600;
+
+// In band tone, and a tone above the Nyquist frequency of the 4x decimated rate (12kHz)
+// which would fold back to 9kHz without the decimation filter
+static const float benchInBandFreq = 1000.0f;
+static const float benchOutOfBandFreq = 15000.0f;
+static const float benchAliasFreq = 9000.0f;
+
+static DelayLine<float, benchDelaySize> DSY_SDRAM_BSS benchFullRate;
+static float DSY_SDRAM_BSS benchDecimatedBuffer[benchDelaySize];
+static float DSY_SDRAM_BSS benchOut[benchSamples];
+
+// Returns the magnitude of a single frequency in the buffer using the Goertzel algorithm
+static float Goertzel(const float *buffer, size_t size, float freq)
+{
+    float coeff = 2.0f * cosf(2.0f * PI_VAL * freq / sampleRateHz);
+    float s1 = 0.0f;
+    float s2 = 0.0f;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        float s0 = buffer[i] + (coeff * s1) - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+
+    return sqrtf((s1 * s1) + (s2 * s2) - (coeff * s1 * s2));
+}
+
+// Run a tone through a delay line, keeping the output once the delayed tone has arrived
+template <typename Line>
+static void RunTone(Line &line, float freq, CycleCounter &counter)
+{
+    for (size_t i = 0; i < benchDelay + benchSamples; i++)
+    {
+        float in = sinf(2.0f * PI_VAL * freq * (float)i / sampleRateHz);
+
+        counter.Start();
+        float out = line.Read();
+        line.Write(in);
+        counter.Stop(1);
+
+        if (i >= benchDelay)
+        {
+            benchOut[i - benchDelay] = out;
+        }
+    }
+}
+
+// Run both tones through a delay line and print the cost, in band level, out of band rejection and alias level
+template <typename Line>
+static void BenchmarkLine(const char *name, Line &line)
+{
+    CycleCounter counter;
+
+    // A full scale sine of benchSamples samples has a Goertzel magnitude of benchSamples / 2
+    const float reference = (float)benchSamples / 2.0f;
+
+    line.Reset();
+    line.SetDelay(benchDelay);
+    RunTone(line, benchInBandFreq, counter);
+    float inBandDb = 20.0f * log10f(Goertzel(benchOut, benchSamples, benchInBandFreq) / reference + 1e-9f);
+
+    line.Reset();
+    line.SetDelay(benchDelay);
+    RunTone(line, benchOutOfBandFreq, counter);
+    float outOfBandDb = 20.0f * log10f(Goertzel(benchOut, benchSamples, benchOutOfBandFreq) / reference + 1e-9f);
+    float aliasDb = 20.0f * log10f(Goertzel(benchOut, benchSamples, benchAliasFreq) / reference + 1e-9f);
+
+    debugPrint(name);
+    debugPrint(": ");
+    debugPrintF(counter.CyclesPerSample(), 1);
+    debugPrint(" cycles/sample, 1kHz ");
+    debugPrintF(inBandDb, 2);
+    debugPrint(" dB, 15kHz ");
+    debugPrintF(outOfBandDb, 1);
+    debugPrint(" dB, 9kHz alias ");
+    debugPrintF(aliasDb, 1);
+    debugPrintln(" dB");
+}
+
+void RunDelayBenchmark()
+{
+    DecimatedDelayLine decimated;
+
+    debugPrintln("Delay benchmark:");
+
+    benchFullRate.Init();
+    BenchmarkLine("Full rate", benchFullRate);
+
+    decimated.Init(benchDecimatedBuffer, benchDelaySize, 2);
+    BenchmarkLine("Decimated 2x", decimated);
+
+    decimated.Init(benchDecimatedBuffer, benchDelaySize, 4);
+    BenchmarkLine("Decimated 4x", decimated);
+}
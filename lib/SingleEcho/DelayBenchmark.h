@@ -0,0 +1,16 @@
+#ifndef DELAY_BENCHMARK_H
+#define DELAY_BENCHMARK_H
+
+#include "DaisyDuino.h"
+#include "../../include/PedalConfig.h"
+#include "../Utility/CycleCounter.h"
+#include "DecimatedDelayLine.h"
+
+/**
+ * Compares the full rate delay line against the 2x and 4x decimated ones: cost in cycles
+ * per sample, how cleanly an in-band tone passes, and how far an out of band tone (which
+ * would alias without the decimation filters) is rejected
+ */
+void RunDelayBenchmark();
+
+#endif
@@ -0,0 +1,97 @@
+#include "GrainBenchmark.h"
+
+static const size_t benchLineSize = 96000;
+static const float benchDelay = 24000.0f;
+static const size_t benchGrainSize = 3840;
+static const size_t benchSamples = 9600;
+
+// The tone and its octave land exactly on Goertzel bins over benchSamples
+static const float benchToneFreq = 500.0f;
+static const float benchOctaveFreq = 1000.0f;
+
+static LazyDelayLine<float, benchLineSize> DSY_SDRAM_BSS benchLine;
+static float DSY_SDRAM_BSS benchOut[benchSamples];
+
+// Returns the magnitude of a single frequency in the buffer using the Goertzel algorithm
+static float Goertzel(const float *buffer, size_t size, float freq)
+{
+    float coeff = 2.0f * cosf(2.0f * PI_VAL * freq / sampleRateHz);
+    float s1 = 0.0f;
+    float s2 = 0.0f;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        float s0 = buffer[i] + (coeff * s1) - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+
+    return sqrtf((s1 * s1) + (s2 * s2) - (coeff * s1 * s2));
+}
+
+void RunGrainBenchmark()
+{
+    const size_t counts[] = {2, 4, 8, 16};
+
+    CycleCounter counter;
+    GrainShifter shifter;
+
+    debugPrintln("Grain benchmark:");
+
+    for (size_t c = 0; c < 4; c++)
+    {
+        shifter.Init(benchGrainSize, counts[c], 2.0f);
+        benchLine.Init();
+
+        // Fill the line past the deepest grain and let the pool fill up, then measure
+        size_t sample = 0;
+        for (; sample < (size_t)benchDelay + (2 * benchGrainSize); sample++)
+        {
+            float in = sinf(2.0f * PI_VAL * benchToneFreq * (float)sample / sampleRateHz);
+            if (sample >= (size_t)benchDelay)
+            {
+                shifter.Process(benchLine, benchDelay);
+            }
+            benchLine.Write(in);
+        }
+
+        counter.Reset();
+        for (size_t i = 0; i < benchSamples; i++, sample++)
+        {
+            float in = sinf(2.0f * PI_VAL * benchToneFreq * (float)sample / sampleRateHz);
+
+            counter.Start();
+            benchOut[i] = shifter.Process(benchLine, benchDelay);
+            counter.Stop(1);
+
+            benchLine.Write(in);
+        }
+
+        // Octave level relative to what is left of the original pitch
+        float octave = Goertzel(benchOut, benchSamples, benchOctaveFreq);
+        float original = Goertzel(benchOut, benchSamples, benchToneFreq);
+        float octaveDb = 20.0f * log10f(octave / (original + 1e-9f) + 1e-9f);
+        float cycles = counter.CyclesPerSample();
+
+        // Output level relative to the input tone, it should stay near 0dB whatever the grain count
+        float power = 0.0f;
+        for (size_t i = 0; i < benchSamples; i++)
+        {
+            power += benchOut[i] * benchOut[i];
+        }
+        float levelDb = 10.0f * log10f((2.0f * power / (float)benchSamples) + 1e-9f);
+
+        debugPrint(counts[c]);
+        debugPrint(" grains: ");
+        debugPrintF(cycles, 1);
+        debugPrint(" cycles/sample, ");
+        debugPrintF(cycles / (float)counts[c], 1);
+        debugPrint(" cycles/grain, worst ");
+        debugPrint(counter.MaxCycles());
+        debugPrint(" cycles, octave ");
+        debugPrintF(octaveDb, 1);
+        debugPrint(" dB over the original, level ");
+        debugPrintF(levelDb, 1);
+        debugPrintln(" dB");
+    }
+}
@@ -0,0 +1,17 @@
+#ifndef GRAIN_BENCHMARK_H
+#define GRAIN_BENCHMARK_H
+
+#include "DaisyDuino.h"
+#include "../../include/PedalConfig.h"
+#include "../Utility/CycleCounter.h"
+#include "../Utility/MemoryPlacement.h"
+#include "GrainShifter.h"
+#include "LazyDelayLine.h"
+
+/**
+ * Measures the grain shifter cost in cycles per sample, and per active grain, as the number of
+ * overlapping grains grows, and how much of a tone ends up an octave up
+ */
+void RunGrainBenchmark();
+
+#endif
@@ -0,0 +1,123 @@
+#include "GrainShifter.h"
+
+// Hann window shared by every grain, built on the first Init
+static float DTCM_BSS grainWindow[grainWindowSize + 1];
+static bool grainWindowReady = false;
+
+// Portion of a grain length used to spread the grain start positions
+static const float grainSpread = 0.25f;
+
+void GrainShifter::Init(size_t pGrainSize, size_t pGrainCount, float pRatio)
+{
+    if (!grainWindowReady)
+    {
+        for (size_t i = 0; i <= grainWindowSize; i++)
+        {
+            grainWindow[i] = 0.5f - (0.5f * cosf(2.0f * PI_VAL * (float)i / (float)grainWindowSize));
+        }
+        grainWindowReady = true;
+    }
+
+    grainSize = (pGrainSize > 0) ? pGrainSize : 1;
+    ratio = pRatio;
+    randomState = 1;
+    SetGrainCount(pGrainCount);
+    Reset();
+}
+
+void GrainShifter::Reset()
+{
+    activeGrains = 0;
+    spawnCountdown = 0;
+}
+
+void GrainShifter::SetRatio(float pRatio)
+{
+    ratio = pRatio;
+}
+
+void GrainShifter::SetGrainCount(size_t pGrainCount)
+{
+    grainCount = (pGrainCount < 2) ? 2 : ((pGrainCount > maxGrains) ? maxGrains : pGrainCount);
+
+    // The grains start at random offsets, so they add up with random phases: their powers sum, not their
+    // amplitudes. Hann windows spaced grainSize / grainCount apart have squares summing to 3 * grainCount / 8
+    normalization = sqrtf(8.0f / (3.0f * (float)grainCount));
+}
+
+size_t GrainShifter::GetActiveGrains()
+{
+    return activeGrains;
+}
+
+ITCM_FUNC void GrainShifter::Prepare(float baseDelay)
+{
+    // Start a grain from the pool when one is due, a full pool waits for the next retirement
+    if (spawnCountdown == 0 && activeGrains < maxGrains)
+    {
+        size_t g = activeGrains++;
+
+        // Faster grains start further back and catch up to the tap, slower ones fall behind it
+        float drift = (ratio - 1.0f) * (float)grainSize;
+        grainOffset[g] = ((drift > 0.0f) ? drift : 0.0f) + (NextRandom() * grainSpread * (float)grainSize);
+        grainOffsetStep[g] = 1.0f - ratio;
+        grainPhase[g] = 0.0f;
+        grainPhaseStep[g] = (float)grainWindowSize / (float)grainSize;
+
+        spawnCountdown = grainSize / grainCount;
+    }
+    if (spawnCountdown > 0)
+    {
+        spawnCountdown--;
+    }
+
+    for (size_t g = 0; g < activeGrains; g++)
+    {
+        grainDelays[g] = baseDelay + grainOffset[g];
+
+        size_t index = (size_t)grainPhase[g];
+        float frac = grainPhase[g] - (float)index;
+        grainWindows[g] = grainWindow[index] + ((grainWindow[index + 1] - grainWindow[index]) * frac);
+    }
+}
+
+ITCM_FUNC float GrainShifter::Finish()
+{
+    float sum = 0.0f;
+    for (size_t g = 0; g < activeGrains; g++)
+    {
+        sum += grainSamples[g] * grainWindows[g];
+    }
+
+    for (size_t g = 0; g < activeGrains; g++)
+    {
+        grainPhase[g] += grainPhaseStep[g];
+        grainOffset[g] += grainOffsetStep[g];
+    }
+
+    // Retire finished grains by moving the last active grain into their slot
+    size_t g = 0;
+    while (g < activeGrains)
+    {
+        if (grainPhase[g] >= (float)grainWindowSize)
+        {
+            size_t last = --activeGrains;
+            grainPhase[g] = grainPhase[last];
+            grainPhaseStep[g] = grainPhaseStep[last];
+            grainOffset[g] = grainOffset[last];
+            grainOffsetStep[g] = grainOffsetStep[last];
+        }
+        else
+        {
+            g++;
+        }
+    }
+
+    return sum * normalization;
+}
+
+float GrainShifter::NextRandom()
+{
+    randomState = (randomState * 1664525u) + 1013904223u;
+    return (float)(randomState >> 8) * (1.0f / 16777216.0f);
+}
@@ -0,0 +1,110 @@
+#ifndef GRAIN_SHIFTER_H
+#define GRAIN_SHIFTER_H
+
+#include "DaisyDuino.h"
+#include "../../include/PedalConfig.h"
+#include "../Utility/MemoryPlacement.h"
+
+// Size of the grain pool, the most grains that can overlap
+static const size_t maxGrains = 16;
+
+// Entries in the window table, one guard entry follows for the interpolation
+static const size_t grainWindowSize = 1024;
+
+/**
+ * Pitch shifts a delay line by reading it with overlapping Hann windowed grains at a different playback rate
+ *
+ * Grains come from a fixed pool with no allocation, and the active ones are kept packed at the front of
+ * structure-of-arrays state so the per-grain loops are straight runs over contiguous floats. Each grain
+ * starts far enough behind the read tap that it can play faster (or slower) than real time for its whole
+ * length without crossing the write head, with a little random spread so overlapping grains do not comb.
+ * The spread makes the grains sum incoherently, so the output is normalized by power and keeps the same
+ * level whatever the grain count. Init() must be called before use.
+ */
+class GrainShifter
+{
+public:
+    /**
+     * Initialize the shifter with no grains playing
+     * @param pGrainSize Length of each grain in samples
+     * @param pGrainCount Number of overlapping grains, 2 to maxGrains
+     * @param pRatio Playback rate of the grains, 2.0 is an octave up
+     */
+    void Init(size_t pGrainSize, size_t pGrainCount, float pRatio);
+
+    /**
+     * Stops all grains
+     */
+    void Reset();
+
+    /**
+     * Sets the playback rate used by new grains, playing grains keep their rate
+     */
+    void SetRatio(float pRatio);
+
+    /**
+     * Sets the number of overlapping grains, 2 to maxGrains
+     */
+    void SetGrainCount(size_t pGrainCount);
+
+    /**
+     * @return Number of grains currently playing
+     */
+    size_t GetActiveGrains();
+
+    /**
+     * Processes one sample, reading the grains from a delay line with a ReadAt(float delay) method
+     * @param line Delay line to read, the caller writes it after this call
+     * @param baseDelay Delay of the tap the grains are shifted from, in samples
+     */
+    template <typename Line>
+    inline float Process(const Line &line, float baseDelay)
+    {
+        Prepare(baseDelay);
+
+        // The only gather, everything else runs over the packed grain state
+        for (size_t g = 0; g < activeGrains; g++)
+        {
+            grainSamples[g] = line.ReadAt(grainDelays[g]);
+        }
+
+        return Finish();
+    }
+
+private:
+    /**
+     * Starts a grain when one is due, then fills the read delay and window gain of each grain
+     */
+    void Prepare(float baseDelay);
+
+    /**
+     * Sums the windowed grains, advances them and retires the finished ones
+     */
+    float Finish();
+
+    /**
+     * Next value of the spread generator, 0 to 1
+     */
+    float NextRandom();
+
+    size_t grainSize;
+    size_t grainCount;
+    float ratio;
+    float normalization;
+    size_t spawnCountdown;
+    uint32_t randomState;
+
+    // Active grains are packed in [0, activeGrains)
+    size_t activeGrains;
+    float grainPhase[maxGrains];
+    float grainPhaseStep[maxGrains];
+    float grainOffset[maxGrains];
+    float grainOffsetStep[maxGrains];
+
+    // Per sample scratch, filled by Prepare and the gather
+    float grainDelays[maxGrains];
+    float grainWindows[maxGrains];
+    float grainSamples[maxGrains];
+};
+
+#endif
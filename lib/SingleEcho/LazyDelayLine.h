@@ -0,0 +1,127 @@
+#ifndef LAZY_DELAY_LINE_H
+#define LAZY_DELAY_LINE_H
+
+#include "DaisyDuino.h"
+
+/**
+ * Delay line with the same interface and pointer movement as DelayLine that never clears its buffer
+ *
+ * Init() and Reset() only reset a watermark of how many samples have been written, and reads past
+ * the watermark return silence, so stale or uninitialized memory is never heard. This makes a reset
+ * O(1) instead of a pass over the whole buffer, and lets the buffer live in memory that is not
+ * zeroed at boot (AXI_OR_SDRAM_NOINIT).
+ *
+ * Has no default member initializers so it can be placed in a NOLOAD section, Init() must be called before use.
+ */
+template <typename T, size_t maxSize>
+class LazyDelayLine
+{
+public:
+    /**
+     * Initialize the delay line, the buffer contents are ignored until overwritten
+     */
+    void Init()
+    {
+        delay = 1;
+        frac = 0.0f;
+        Reset();
+    }
+
+    /**
+     * Forgets everything written so far, reads return silence until the line refills
+     */
+    void Reset()
+    {
+        writePtr = 0;
+        written = 0;
+    }
+
+    /**
+     * Sets the delay in whole samples
+     */
+    inline void SetDelay(size_t samples)
+    {
+        frac = 0.0f;
+        delay = (samples < maxSize) ? samples : (maxSize - 1);
+    }
+
+    /**
+     * Sets the delay in samples, the fraction is linearly interpolated
+     */
+    inline void SetDelay(float samples)
+    {
+        size_t whole = (size_t)samples;
+        frac = samples - (float)whole;
+        delay = (whole < maxSize) ? whole : (maxSize - 1);
+    }
+
+    /**
+     * Reads the sample at the current delay
+     */
+    inline T Read() const
+    {
+        T a = Sample(delay);
+        T b = Sample(delay + 1);
+        return a + ((b - a) * frac);
+    }
+
+    /**
+     * Reads at any delay without moving the tap, the fraction is linearly interpolated
+     * @param delaySamples Delay in samples, clamped to the length of the line
+     */
+    inline T ReadAt(float delaySamples) const
+    {
+        size_t whole = (delaySamples > 0.0f) ? (size_t)delaySamples : 0;
+        float f = (delaySamples > 0.0f) ? (delaySamples - (float)whole) : 0.0f;
+        if (whole > maxSize - 2)
+        {
+            whole = maxSize - 2;
+            f = 0.0f;
+        }
+
+        T a = Sample(whole);
+        T b = Sample(whole + 1);
+        return a + ((b - a) * f);
+    }
+
+    /**
+     * Writes the next sample
+     */
+    inline void Write(const T sample)
+    {
+        line[writePtr] = sample;
+        writePtr = (writePtr == 0) ? (maxSize - 1) : (writePtr - 1);
+
+        if (written < maxSize)
+        {
+            written++;
+        }
+    }
+
+private:
+    /**
+     * Sample written age writes ago, silence if that is past the watermark
+     */
+    inline T Sample(size_t age) const
+    {
+        if (age > written)
+        {
+            return T(0);
+        }
+
+        size_t index = writePtr + age;
+        if (index >= maxSize)
+        {
+            index -= maxSize;
+        }
+        return line[index];
+    }
+
+    float frac;
+    size_t writePtr;
+    size_t delay;
+    size_t written;
+    T line[maxSize];
+};
+
+#endif
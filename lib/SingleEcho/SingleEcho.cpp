@@ -14,15 +14,61 @@
 //    - 500ms = 24000
 //    - Formula: (96000 * t) / 2000
 
+// LONG MODE NOTES:
+//  - Long mode stores the echo at 1/longDelayFactor of the sample rate in SDRAM,
+//    giving longDelayFactor times the delay time of the full rate line
+//  - Tap durations up to maxTapDuration * longDelayFactor are accepted in long mode
+//  - Repeats in long mode are band limited to sampleRateHz / (2 * longDelayFactor)
+
+// SHIMMER NOTES:
+//  - Grains read the full rate line an octave up and replace part of the repeat that is fed back,
+//    so every repeat climbs another octave while the echo heard directly stays at pitch
+//  - The grains trail the echo tap by up to shimmerGrainSize samples
+//  - Shimmer has no effect in long mode, the decimated line is band limited below the shifted octave anyway
+
+// PRESET NOTES:
+//  - Tempo and the knob levels are restored from QSPI flash in Setup, before audio starts
+//  - A restored level holds until its knob is moved past the jitter threshold
+//  - The delay type, long mode and shimmer follow their switches, which keep their position without power
+//  - Settings are saved once they have been stable for presetSaveDelay ms
+
+// Storage for the full rate delay line, kept out of the object so the object fits in DTCM
+// It is cleared lazily, so it sits in memory that the startup code does not zero
+static LazyDelayLine<float, delayMaxSize> AXI_OR_SDRAM_NOINIT del_line;
+
+// Storage for the long (decimated) delay line
+static float DSY_SDRAM_BSS longDelayBuffer[longDelayMaxSize];
+
 // Initialize the delay
 void SingleEcho::Setup(size_t pNumChannels)
 {
-    // Init Delay Line
+    // Init Delay Lines (no clearing, so this does not hold up the start of audio)
     del_line.Init();
+    long_del_line.Init(longDelayBuffer, longDelayMaxSize, longDelayFactor);
+
+    // Restore the last saved settings
+    presets.Init(singleEchoPresetAddress, singleEchoPresetVersion);
+    SingleEchoPreset restored;
+    bool presetLoaded = presets.Load(&restored, sizeof(restored));
 
     // Set Delay Time in Samples
     currentTempoSamples = ((96000 / initialTempoBpm) * 30) * tempoModifier;
-    del_line.SetDelay(currentTempoSamples);
+    if (presetLoaded && restored.tempoSamples > 0)
+    {
+        currentTempoSamples = restored.tempoSamples;
+    }
+    SetDelay(currentTempoSamples);
+
+    // Initialize the long mode switch
+    pinMode(longModeSwitchPin, INPUT);
+    longMode = false;
+    LongModeLoopControl();
+
+    // Initialize the shimmer switch and grain pool
+    pinMode(shimmerSwitchPin, INPUT);
+    shimmer.Init(shimmerGrainSize, shimmerGrainCount, shimmerRatio);
+    shimmerMode = false;
+    ShimmerLoopControl();
 
     // Initialize the tap tempo button
     tapTempoButton.Init(
@@ -37,6 +83,32 @@ void SingleEcho::Setup(size_t pNumChannels)
     // Initialize the volume boost
     volumeBoost.Init(volumeBoostPin, INPUT, volumeBoostLevel, boostMinValue, boostMaxValue);
 
+    // Initialize the damping filter in the feedback path
+    damping.Init(dampingKnobPin, INPUT, dampingValue, minDampingValue, maxDampingValue);
+
+    // Restored levels override the knob positions until the knobs are moved
+    if (presetLoaded)
+    {
+        levelValue = PresetStore::Dequantize(restored.level, minLevelValue, maxLevelValue);
+        decayValue = PresetStore::Dequantize(restored.decay, minDecayValue, maxDecayValue);
+        volumeBoostLevel = PresetStore::Dequantize(restored.boost, boostMinValue, boostMaxValue);
+        dampingValue = PresetStore::Dequantize(restored.damping, minDampingValue, maxDampingValue);
+        debugPrintln("Restored the saved preset");
+    }
+
+    dampingFilter.Init(sampleRateHz);
+    dampingFilter.SetFrequency(dampingValue);
+
+    // Initialize the saturation stages, the boost soft clips instead of hard clipping the codec
+    boostSaturator.Init(saturationOversampling, SHAPER_SOFT_CLIP);
+    feedbackSaturator.Init(saturationOversampling, SHAPER_TANH);
+    feedbackSaturator.SetDrive(feedbackDriveValue);
+
+    // Initialize the output limiter, the boost and the repeats together can go well past full scale
+    outputLimiter.Init(sampleRateHz, limiterLookahead);
+    outputLimiter.SetThreshold(limiterThreshold);
+    outputLimiter.SetRelease(limiterReleaseMs);
+
     // Initialize the type pins
     typeSwitcher.Init(typeSwitcherPin1, INPUT, typeSwitcherPin2, INPUT);
     pinMode(quarterDelayLedPin, OUTPUT);
@@ -45,33 +117,67 @@ void SingleEcho::Setup(size_t pNumChannels)
 
     // Initialize the type
     TypeSwitcherLoopControl();
+
+    // Only save once something changes from here
+    FillPreset(savedPreset);
+    pendingPreset = savedPreset;
 }
 
 // Clean up the parameters for mono delay
 void SingleEcho::Cleanup()
 {
     del_line.Reset();
+    long_del_line.Reset();
+    shimmer.Reset();
+    dampingFilter.Reset();
+    boostSaturator.Reset();
+    feedbackSaturator.Reset();
+    outputLimiter.Reset();
 }
 
 // Audio callback when audio input occurs
-void SingleEcho::AudioCallback(float **in, float **out, size_t size)
+ITCM_FUNC void SingleEcho::AudioCallback(float **in, float **out, size_t size)
 {
+#if BENCHMARK
+    callbackCycles.Start();
+#endif
+
     for (size_t i = 0; i < size; i++)
     {
         float dry, wet;
 
-        // Read Dry from I/O
-        dry = in[AUDIO_IN_CH][i] * volumeBoostLevel;
+        // Read Dry from I/O and drive it through the boost
+        dry = boostSaturator.Process(in[AUDIO_IN_CH][i] * volumeBoostLevel);
 
         // Read Wet from Delay Line
-        wet = del_line.Read();
+        wet = longMode ? long_del_line.Read() : del_line.Read();
 
-        // Write to Delay with a controlled decay time
-        del_line.Write((wet * decayValue) + dry);
+        // Blend an octave up copy into the repeat that is fed back
+        float repeat = wet;
+        if (shimmerMode && !longMode)
+        {
+            float shifted = shimmer.Process(del_line, delaySamples);
+            repeat = wet + ((shifted - wet) * shimmerFeedbackMix);
+        }
 
-        // Mix Dry and Wet and send to I/O
-        out[AUDIO_OUT_CH][i] = ((wet * levelValue) + dry);
+        // Write to Delay with a controlled decay time, damping and saturating the repeats so they darken over time
+        float feedback = feedbackSaturator.Process((dampingFilter.Process(repeat) * decayValue) + dry);
+        if (longMode)
+        {
+            long_del_line.Write(feedback);
+        }
+        else
+        {
+            del_line.Write(feedback);
+        }
+
+        // Mix Dry and Wet and send to I/O through the limiter
+        out[AUDIO_OUT_CH][i] = outputLimiter.Process((wet * levelValue) + dry);
     }
+
+#if BENCHMARK
+    callbackCycles.Stop(size);
+#endif
 }
 
 // Logic for mono delay to add into the main loop
@@ -98,8 +204,41 @@ void SingleEcho::Loop()
         debugPrintln(volumeBoostLevel);
     }
 
+    // Update the damping filter if the knob has been moved
+    if (damping.SetNewValue(dampingValue))
+    {
+        dampingFilter.SetFrequency(dampingValue);
+
+        debugPrint("Updated the damping to: ");
+        debugPrintln(dampingValue);
+    }
+
     // Handle type
     TypeSwitcherLoopControl();
+
+    // Handle long mode
+    LongModeLoopControl();
+
+    // Handle shimmer
+    ShimmerLoopControl();
+
+    // Save settings that have settled
+    PresetLoopControl();
+
+#if BENCHMARK
+    // Report the audio callback cost, reading and clearing the counter without the callback in between
+    if (DEBUG && (millis() - cpuReportTime > cpuReportInterval))
+    {
+        __disable_irq();
+        float cyclesPerSample = callbackCycles.CyclesPerSample();
+        callbackCycles.Reset();
+        __enable_irq();
+
+        debugPrint("Audio callback cycles/sample: ");
+        debugPrintln(cyclesPerSample);
+        cpuReportTime = millis();
+    }
+#endif
 }
 
 // Interrupt handler for the tap tempo button to set the tempo
@@ -109,9 +248,10 @@ void SingleEcho::TapTempoInterruptHandler()
 
     // Calculate the duration (ignore a duration longer than 2 seconds)
     unsigned long duration = millis() - tapTempoTime;
-    if (duration < 2000)
+    unsigned long tapTimeout = longMode ? (maxTapDuration * longDelayFactor) : maxTapDuration;
+    if (duration < tapTimeout)
     {
-        // Add the duration to the tempo array (cast is safe because duration will never be greater than 2000)
+        // Add the duration to the tempo array (cast is safe because duration will never be greater than the timeout)
         tempoArray.push(duration);
 
         // Calculate the average duration of the items in the array
@@ -119,7 +259,7 @@ void SingleEcho::TapTempoInterruptHandler()
 
         // Set the new delay based on the calculated duration
         currentTempoSamples = ((96000 * (size_t)avg) / 2000) * tempoModifier;
-        del_line.SetDelay(currentTempoSamples);
+        SetDelay(currentTempoSamples);
     }
     else
     {
@@ -154,7 +294,7 @@ void SingleEcho::TypeSwitcherLoopControl()
             tempoModifier = 1.0f;
 
             // Update the delay tempo
-            del_line.SetDelay(currentTempoSamples * tempoModifier);
+            SetDelay(currentTempoSamples * tempoModifier);
 
             // Turn off other LEDs
             analogWrite(tripletLedPin, 0);
@@ -176,7 +316,7 @@ void SingleEcho::TypeSwitcherLoopControl()
             tempoModifier = 0.333f;
 
             // Update the delay tempo
-            del_line.SetDelay(currentTempoSamples * tempoModifier);
+            SetDelay(currentTempoSamples * tempoModifier);
 
             // Turn off other LEDs
             analogWrite(quarterDelayLedPin, 0);
@@ -198,7 +338,7 @@ void SingleEcho::TypeSwitcherLoopControl()
             tempoModifier = 0.75f;
 
             // Update the delay tempo
-            del_line.SetDelay(currentTempoSamples * tempoModifier);
+            SetDelay(currentTempoSamples * tempoModifier);
 
             // Turn off other LEDs
             analogWrite(tripletLedPin, 0);
@@ -208,4 +348,94 @@ void SingleEcho::TypeSwitcherLoopControl()
             analogWrite(dottedEighthLedPin, ledIntensity);
         }
     }
+}
+
+// Set the delay time of both delay lines
+void SingleEcho::SetDelay(float samples)
+{
+    del_line.SetDelay(samples);
+    delaySamples = samples;
+    long_del_line.SetDelay((size_t)samples);
+}
+
+// Handle reading the long mode switch and swapping delay lines
+void SingleEcho::LongModeLoopControl()
+{
+    bool newLongMode = (digitalRead(longModeSwitchPin) == HIGH);
+
+    // Only switch if the mode has changed
+    if (newLongMode != longMode)
+    {
+        debugPrintln(newLongMode ? "Changing to long mode" : "Changing to full rate mode");
+
+        // Clear the line that is about to be used, the audio callback is not touching it yet
+        if (newLongMode)
+        {
+            long_del_line.Reset();
+        }
+        else
+        {
+            del_line.Reset();
+        }
+
+        longMode = newLongMode;
+    }
+}
+
+// Handle reading the shimmer switch
+void SingleEcho::ShimmerLoopControl()
+{
+    bool newShimmerMode = (digitalRead(shimmerSwitchPin) == HIGH);
+
+    // Only switch if the mode has changed
+    if (newShimmerMode != shimmerMode)
+    {
+        debugPrintln(newShimmerMode ? "Turning shimmer on" : "Turning shimmer off");
+
+        // Start from an empty grain pool, the audio callback is not touching it yet
+        if (newShimmerMode)
+        {
+            shimmer.Reset();
+        }
+
+        shimmerMode = newShimmerMode;
+    }
+}
+
+// Save the settings once they have stopped changing
+void SingleEcho::PresetLoopControl()
+{
+    SingleEchoPreset current;
+    FillPreset(current);
+
+    // Restart the settle timer on every change
+    if (memcmp(&current, &pendingPreset, sizeof(current)) != 0)
+    {
+        pendingPreset = current;
+        presetChangeTime = millis();
+    }
+    else if (memcmp(&pendingPreset, &savedPreset, sizeof(pendingPreset)) != 0 && (millis() - presetChangeTime > presetSaveDelay))
+    {
+        // Blocks the loop for the flash write (and a sector erase every 128 saves), audio keeps running
+        if (presets.Save(&pendingPreset, sizeof(pendingPreset)))
+        {
+            debugPrintln("Saved the preset");
+        }
+        else
+        {
+            debugPrintln("Failed to save the preset");
+        }
+
+        savedPreset = pendingPreset;
+    }
+}
+
+// Capture the current settings
+void SingleEcho::FillPreset(SingleEchoPreset &preset)
+{
+    preset.tempoSamples = (uint32_t)currentTempoSamples;
+    preset.level = PresetStore::Quantize(levelValue, minLevelValue, maxLevelValue);
+    preset.decay = PresetStore::Quantize(decayValue, minDecayValue, maxDecayValue);
+    preset.boost = PresetStore::Quantize(volumeBoostLevel, boostMinValue, boostMaxValue);
+    preset.damping = PresetStore::Quantize(dampingValue, minDampingValue, maxDampingValue);
 }
\ No newline at end of file
@@ -5,16 +5,25 @@
 #include "../../include/IEffect.h"
 #include "../../include/PedalConfig.h"
 #include "TempoArray.h"
+#include "DecimatedDelayLine.h"
+#include "LazyDelayLine.h"
+#include "GrainShifter.h"
 #include "../Inputs/NFNToggle.h"
 #include "../Inputs/Knob.h"
 #include "../Inputs/Button.h"
+#include "../Filters/OnePoleFilter.h"
+#include "../Saturation/Saturator.h"
+#include "../Dynamics/LookaheadLimiter.h"
+#include "../Utility/CycleCounter.h"
+#include "../Presets/PresetStore.h"
+#include "../Utility/MemoryPlacement.h"
 
 /**********************************************
  * Mono Delay Effect
  * 
  * SPST 1 - Tap Tempo
- * SPST 2 - N/U
- * SPST 3 - N/U
+ * SPST 2 - Long Mode
+ * SPST 3 - Shimmer
  * SPST 4 - N/U
  * 
  * SPDT 1 - Type Switcher
@@ -23,7 +32,7 @@
  * Knob 1 - Effect Level
  * Knob 2 - Decay
  * Knob 3 - Volume Boost
- * Knob 4 - N/U
+ * Knob 4 - Damping
  * 
  * LED 1 - Quarter
  * LED 2 - Dotted Eighth
@@ -33,9 +42,12 @@
 
 // Pin renaming
 static const int tapTempoButtonPin = effectSPSTPin4;
+static const int longModeSwitchPin = effectSPSTPin3;
+static const int shimmerSwitchPin = effectSPSTPin2;
 static const int levelKnobPin = effectPotPin4;
 static const int decayKnobPin = effectPotPin2;
 static const int volumeBoostPin = effectPotPin3;
+static const int dampingKnobPin = effectPotPin1;
 static const int typeSwitcherPin1 = effectSPDT2Pin1;
 static const int typeSwitcherPin2 = effectSPDT2Pin2;
 static const int quarterDelayLedPin = effectLedPin1;
@@ -44,10 +56,13 @@ static const int tripletLedPin = effectLedPin3;
 
 // Constant parameters
 static const size_t delayMaxSize = 96000;
+static const size_t longDelayMaxSize = 96000;
+static const size_t longDelayFactor = 4;
 static const size_t ledIntensity = 128;
 
 // Tap tempo constants
 static const size_t initialTempoBpm = 90;
+static const unsigned long maxTapDuration = 2000;
 
 // Decay constants
 static const float minDecayValue = 0.75f;
@@ -61,6 +76,33 @@ static const float maxLevelValue = 0.0f;
 static const float boostMinValue = 7.0f;
 static const float boostMaxValue = 1.0f;
 
+// Damping constants (cutoff of the feedback filter in Hz)
+static const float minDampingValue = 1200.0f;
+static const float maxDampingValue = 20000.0f;
+
+// Saturation constants
+static const size_t saturationOversampling = 2;
+static const float feedbackDriveValue = 1.0f;
+
+// Output limiter constants, 1ms of lookahead keeping the mix just under the codec's full scale
+static const size_t limiterLookahead = 96;
+static const float limiterThreshold = 0.98f;
+static const float limiterReleaseMs = 100.0f;
+
+// Shimmer constants, 40ms grains an octave up with half of the fed back repeat replaced by the shifted copy
+static const size_t shimmerGrainSize = 3840;
+static const size_t shimmerGrainCount = 4;
+static const float shimmerRatio = 2.0f;
+static const float shimmerFeedbackMix = 0.5f;
+
+// Preset constants, the last two sectors of the QSPI flash
+static const uint32_t singleEchoPresetAddress = presetFlashSize - presetStoreSize;
+static const uint8_t singleEchoPresetVersion = 1;
+static const unsigned long presetSaveDelay = 2000;
+
+// Debug report interval in milliseconds
+static const unsigned long cpuReportInterval = 1000;
+
 // Type constants
 enum DelayType
 {
@@ -71,6 +113,19 @@ enum DelayType
     DT_UNSET = 99
 };
 
+/**
+ * Settings saved across power cycles (payload version 1)
+ * Levels are quantized over their knob range, packed so the layout does not depend on the compiler
+ */
+struct __attribute__((packed)) SingleEchoPreset
+{
+    uint32_t tempoSamples;
+    uint16_t level;
+    uint16_t decay;
+    uint16_t boost;
+    uint16_t damping;
+};
+
 class SingleEcho : public IEffect
 {
 public:
@@ -88,19 +143,46 @@ private:
     void SetDecayValue(int knobReading);
     void SetLevelValue(int knobReading);
     void SetType();
+    void SetDelay(float samples);
+    void LongModeLoopControl();
+    void ShimmerLoopControl();
+    void PresetLoopControl();
+    void FillPreset(SingleEchoPreset &preset);
 
     // Input handlers
     NFNToggle typeSwitcher;
     Knob effectLevel;
     Knob decay;
     Knob volumeBoost;
+    Knob damping;
     Button tapTempoButton;
 
     // Mutable parameters
-    DelayLine<float, delayMaxSize> del_line;
+    DecimatedDelayLine long_del_line;
+    bool longMode = false;
+    GrainShifter shimmer;
+    bool shimmerMode = false;
+    float delaySamples = 0.0f;
     float decayValue = 0.5f;
     float levelValue = 0.5f;
     float volumeBoostLevel = 0.0f;
+    float dampingValue = maxDampingValue;
+    OnePoleFilter dampingFilter;
+    Saturator boostSaturator;
+    Saturator feedbackSaturator;
+    LookaheadLimiter outputLimiter;
+
+    // Presets
+    PresetStore presets;
+    SingleEchoPreset savedPreset;
+    SingleEchoPreset pendingPreset;
+    unsigned long presetChangeTime = 0;
+
+#if BENCHMARK
+    // CPU usage, only measured in benchmark builds
+    CycleCounter callbackCycles;
+    unsigned long cpuReportTime = 0;
+#endif
 
     // Tap tempo mutables
     size_t currentTempoSamples;
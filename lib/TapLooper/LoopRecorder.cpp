@@ -0,0 +1,412 @@
+#include "LoopRecorder.h"
+
+// LOOP LAYOUT NOTES:
+//  - Position 0 to looperHeadSize - 1 lives in the head buffer (internal RAM)
+//  - Position looperHeadSize onwards is split into chunks of looperChunkSize samples in SDRAM,
+//    chunk n starts at storage[n * looperChunkSize]
+//  - Every chunk the audio callback enters gets the next sequence number, and sequence n is
+//    cached in slot n % looperCacheChunks. While recording, sequence n is chunk n; while
+//    playing it is chunk n % numChunks
+//  - Service() only looks ahead by fewer chunks than the loop has, so a chunk is never cached
+//    twice and an overdubbed chunk is always written back before it is read again
+//  - A recording slot starts out silent and dirty, so whatever the callback misses of that chunk
+//    is stored as silence, and chunks the callback got past before Service() reached them are
+//    silenced in SDRAM directly
+
+void LoopRecorder::Init(LoopSample *pStorage, LoopBuffers *pBuffers)
+{
+    storage = pStorage;
+    buffers = pBuffers;
+
+    for (size_t s = 0; s < looperCacheChunks; s++)
+    {
+        slotState[s] = SLOT_FREE;
+        slotDirty[s] = false;
+        slotGeneration[s] = 0;
+        slotSequence[s] = 0;
+        slotChunk[s] = 0;
+    }
+
+    fillGeneration = 0;
+    fillSequence = 0;
+    tapRequested = false;
+    clearRequested = false;
+    underruns = 0;
+    ApplyClear();
+}
+
+void LoopRecorder::Clear()
+{
+    clearRequested = true;
+}
+
+void LoopRecorder::Tap()
+{
+    tapRequested = true;
+}
+
+ITCM_FUNC float LoopRecorder::Process(float in)
+{
+    // Apply switch requests on a sample boundary so the loop points are sample accurate
+    if (clearRequested)
+    {
+        clearRequested = false;
+        ApplyClear();
+    }
+    if (tapRequested)
+    {
+        tapRequested = false;
+        ApplyTap();
+    }
+
+    if (state == LOOP_EMPTY)
+    {
+        return 0.0f;
+    }
+
+    // Find the sample at the current position
+    float *sample = nullptr;
+    if (position < looperHeadSize)
+    {
+        sample = &buffers->head[position];
+    }
+    else
+    {
+        if (activeSlot < 0)
+        {
+            AcquireSlot();
+        }
+        if (activeSlot >= 0)
+        {
+            sample = &buffers->cache[activeSlot][chunkOffset];
+        }
+        else
+        {
+            underruns++;
+        }
+    }
+
+    float out = 0.0f;
+    if (sample != nullptr)
+    {
+        switch (state)
+        {
+        case LOOP_RECORDING:
+            *sample = in;
+            break;
+        case LOOP_OVERDUBBING:
+            out = *sample;
+            *sample = out + in;
+            break;
+        case LOOP_PLAYING:
+        default:
+            out = *sample;
+            break;
+        }
+
+        if (activeSlot >= 0 && state != LOOP_PLAYING)
+        {
+            slotDirty[activeSlot] = true;
+        }
+    }
+
+    // Advance the position, moving to the next chunk on a chunk boundary
+    if (position >= looperHeadSize)
+    {
+        chunkOffset++;
+        if (chunkOffset == looperChunkSize)
+        {
+            ReleaseSlot();
+        }
+    }
+    position++;
+
+    if (state == LOOP_RECORDING)
+    {
+        // Close the loop if the storage is full
+        if (position == looperHeadSize + looperStorageSize)
+        {
+            CloseRecording();
+        }
+    }
+    else if (position == loopLength)
+    {
+        // Wrap around, the last chunk may be partial
+        if (chunkOffset != 0)
+        {
+            ReleaseSlot();
+        }
+        position = 0;
+    }
+
+    return out;
+}
+
+void LoopRecorder::Service()
+{
+    // Snapshot the play state, everything below is relative to it
+    uint32_t gen = generation;
+    uint32_t seq = sequence;
+    LoopState currentState = state;
+    size_t chunks = numChunks;
+
+    // Write back chunks the audio callback has finished with
+    for (size_t s = 0; s < looperCacheChunks; s++)
+    {
+        if (slotState[s] == SLOT_DONE)
+        {
+            WriteBack(s);
+            slotState[s] = SLOT_FREE;
+        }
+    }
+
+    if (currentState == LOOP_EMPTY)
+    {
+        return;
+    }
+
+    if (gen != fillGeneration)
+    {
+        fillGeneration = gen;
+        fillSequence = 0;
+    }
+
+    // Silence the chunks recorded over while Service() was held up, they never had a slot
+    bool recording = (currentState == LOOP_RECORDING);
+    if (recording)
+    {
+        while (fillSequence < seq && fillSequence < looperMaxChunks)
+        {
+            SilenceChunk(fillSequence);
+            fillSequence++;
+        }
+    }
+
+    // Fill the current and upcoming chunks
+    size_t lookahead = looperCacheChunks - 1;
+    if (!recording)
+    {
+        if (chunks == 0)
+        {
+            return;
+        }
+        if (lookahead > chunks - 1)
+        {
+            lookahead = chunks - 1;
+        }
+    }
+
+    for (size_t i = 0; i <= lookahead; i++)
+    {
+        uint32_t n = seq + i;
+        size_t slot = n % looperCacheChunks;
+        size_t chunk = recording ? n : (n % chunks);
+
+        if (recording && chunk >= looperMaxChunks)
+        {
+            break;
+        }
+
+        // Already cached
+        if (slotState[slot] == SLOT_READY && slotGeneration[slot] == gen && slotSequence[slot] == n)
+        {
+            continue;
+        }
+
+        // Recorded chunks do not need to be read, they are overwritten as they are played
+        FillSlot(slot, chunk, gen, n, !recording);
+        if (n >= fillSequence)
+        {
+            fillSequence = n + 1;
+        }
+    }
+}
+
+LoopState LoopRecorder::GetState()
+{
+    return state;
+}
+
+size_t LoopRecorder::GetLoopLength()
+{
+    return loopLength;
+}
+
+size_t LoopRecorder::GetUnderruns()
+{
+    return underruns;
+}
+
+// Move through empty -> recording -> playing <-> overdubbing
+void LoopRecorder::ApplyTap()
+{
+    switch (state)
+    {
+    case LOOP_EMPTY:
+        // Start a new recording, invalidating everything that is cached
+        generation++;
+        sequence = 0;
+        position = 0;
+        chunkOffset = 0;
+        activeSlot = -1;
+        state = LOOP_RECORDING;
+        break;
+
+    case LOOP_RECORDING:
+        CloseRecording();
+        break;
+
+    case LOOP_PLAYING:
+        state = LOOP_OVERDUBBING;
+        break;
+
+    case LOOP_OVERDUBBING:
+    default:
+        state = LOOP_PLAYING;
+        break;
+    }
+}
+
+void LoopRecorder::ApplyClear()
+{
+    if (activeSlot >= 0)
+    {
+        slotState[activeSlot] = SLOT_DONE;
+    }
+
+    generation++;
+    sequence = 0;
+    position = 0;
+    chunkOffset = 0;
+    activeSlot = -1;
+    loopLength = 0;
+    numChunks = 0;
+    state = LOOP_EMPTY;
+}
+
+// The loop ends at the current position and plays back from the start
+void LoopRecorder::CloseRecording()
+{
+    // Nothing was recorded
+    if (position == 0)
+    {
+        ApplyClear();
+        return;
+    }
+
+    if (chunkOffset != 0)
+    {
+        ReleaseSlot();
+    }
+
+    loopLength = position;
+    numChunks = (position > looperHeadSize) ? ((position - looperHeadSize + looperChunkSize - 1) / looperChunkSize) : 0;
+
+    // Chunk numbering restarts for playback
+    generation++;
+    sequence = 0;
+    position = 0;
+    chunkOffset = 0;
+    activeSlot = -1;
+    state = LOOP_PLAYING;
+}
+
+ITCM_FUNC void LoopRecorder::AcquireSlot()
+{
+    size_t slot = sequence % looperCacheChunks;
+
+    if (slotState[slot] == SLOT_READY && slotGeneration[slot] == generation && slotSequence[slot] == sequence)
+    {
+        activeSlot = (int)slot;
+    }
+}
+
+ITCM_FUNC void LoopRecorder::ReleaseSlot()
+{
+    if (activeSlot >= 0)
+    {
+        slotState[activeSlot] = SLOT_DONE;
+        activeSlot = -1;
+    }
+
+    chunkOffset = 0;
+    sequence++;
+}
+
+void LoopRecorder::FillSlot(size_t slot, size_t chunk, uint32_t gen, uint32_t seq, bool read)
+{
+    // Save whatever the slot held before reusing it
+    if (slotDirty[slot])
+    {
+        WriteBack(slot);
+    }
+
+    slotState[slot] = SLOT_FILLING;
+
+    float *dst = buffers->cache[slot];
+    if (read)
+    {
+        const LoopSample *src = &storage[chunk * looperChunkSize];
+        for (size_t i = 0; i < looperChunkSize; i++)
+        {
+#if LOOPER_COMPRESS_INT16
+            dst[i] = (float)src[i] * (1.0f / 32767.0f);
+#else
+            dst[i] = src[i];
+#endif
+        }
+    }
+    else
+    {
+        // A recording slot is written back even if the callback never reaches it
+        for (size_t i = 0; i < looperChunkSize; i++)
+        {
+            dst[i] = 0.0f;
+        }
+    }
+
+    slotChunk[slot] = chunk;
+    slotGeneration[slot] = gen;
+    slotSequence[slot] = seq;
+    slotDirty[slot] = !read;
+    slotState[slot] = SLOT_READY;
+}
+
+void LoopRecorder::WriteBack(size_t slot)
+{
+    if (!slotDirty[slot])
+    {
+        return;
+    }
+
+    const float *src = buffers->cache[slot];
+    LoopSample *dst = &storage[slotChunk[slot] * looperChunkSize];
+    for (size_t i = 0; i < looperChunkSize; i++)
+    {
+#if LOOPER_COMPRESS_INT16
+        float clamped = src[i];
+        if (clamped > 1.0f)
+        {
+            clamped = 1.0f;
+        }
+        else if (clamped < -1.0f)
+        {
+            clamped = -1.0f;
+        }
+        dst[i] = (LoopSample)(clamped * 32767.0f);
+#else
+        dst[i] = src[i];
+#endif
+    }
+
+    slotDirty[slot] = false;
+}
+
+void LoopRecorder::SilenceChunk(size_t chunk)
+{
+    LoopSample *dst = &storage[chunk * looperChunkSize];
+    for (size_t i = 0; i < looperChunkSize; i++)
+    {
+        dst[i] = 0;
+    }
+}
@@ -0,0 +1,160 @@
+#ifndef LOOP_RECORDER_H
+#define LOOP_RECORDER_H
+
+#include "DaisyDuino.h"
+#include "../../include/PedalConfig.h"
+#include "../Utility/MemoryPlacement.h"
+
+// Set to 1 to store the loop as 16 bit samples, which doubles the maximum loop length
+#define LOOPER_COMPRESS_INT16 1
+
+#if LOOPER_COMPRESS_INT16
+typedef int16_t LoopSample;
+static const size_t looperMaxSeconds = 300;
+#else
+typedef float LoopSample;
+static const size_t looperMaxSeconds = 150;
+#endif
+
+// Storage and cache sizes
+static const size_t looperChunkSize = 512;
+static const size_t looperCacheChunks = 8;
+static const size_t looperHeadSize = 2048;
+static const size_t looperMaxChunks = ((size_t)sampleRateHz * looperMaxSeconds - looperHeadSize) / looperChunkSize;
+static const size_t looperStorageSize = looperMaxChunks * looperChunkSize;
+
+/**
+ * Internal RAM the audio callback plays from, the first looperHeadSize samples and the chunk cache
+ * Has no constructor so it can be placed with DTCM_OR_SDRAM_BSS, nothing in it needs clearing
+ */
+struct LoopBuffers
+{
+    float head[looperHeadSize];
+    float cache[looperCacheChunks][looperChunkSize];
+};
+
+enum LoopState
+{
+    LOOP_EMPTY = 0,
+    LOOP_RECORDING = 1,
+    LOOP_PLAYING = 2,
+    LOOP_OVERDUBBING = 3
+};
+
+/**
+ * Record/overdub/play engine for loops far longer than internal RAM
+ *
+ * The loop lives in SDRAM in chunks of looperChunkSize samples, except for the first
+ * looperHeadSize samples which always stay in internal RAM. The audio callback only ever
+ * touches the head and a small cache of chunks (LoopBuffers) in internal RAM, while Service(),
+ * called from Loop(), reads upcoming chunks ahead of the play position and writes finished
+ * (recorded or overdubbed) chunks back behind it. The head gives Service() time to fetch the first chunks
+ * whenever the loop wraps or the recording is closed. The stock memory layout has no room for
+ * LoopBuffers in internal RAM, so there the callback works out of SDRAM through the data cache.
+ *
+ * Cache slots are owned by either side through a state flag, so no locking is needed:
+ * Service() moves a slot FREE -> FILLING -> READY and DONE -> FREE, the audio callback only
+ * moves READY -> DONE. A slot is tagged with the generation (bumped on record/clear) and the
+ * sequence number of the chunk it holds, and the callback only uses a slot whose tag matches.
+ *
+ * If Service() falls behind, the samples the callback has no chunk for play as silence and
+ * are left out of an overdub. While recording they are stored as silence, so an older loop
+ * never shows through.
+ */
+class LoopRecorder
+{
+public:
+    /**
+     * Initialize the recorder
+     * @param pStorage SDRAM buffer of at least looperStorageSize samples, it does not need to be cleared
+     * @param pBuffers Head and cache buffers, they do not need to be cleared
+     */
+    void Init(LoopSample *pStorage, LoopBuffers *pBuffers);
+
+    /**
+     * Clears the loop, takes effect on the next processed sample
+     */
+    void Clear();
+
+    /**
+     * Advances the record/play/overdub state, takes effect on the next processed sample
+     */
+    void Tap();
+
+    /**
+     * Processes a single sample and returns the loop output (not including the input)
+     */
+    float Process(float in);
+
+    /**
+     * Moves chunks between the cache and SDRAM, must be called regularly from Loop()
+     */
+    void Service();
+
+    /**
+     * @return Current state of the loop
+     */
+    LoopState GetState();
+
+    /**
+     * @return Length of the loop in samples, 0 until the first recording is closed
+     */
+    size_t GetLoopLength();
+
+    /**
+     * @return Number of samples the audio callback found no cached chunk for
+     */
+    size_t GetUnderruns();
+
+private:
+    enum SlotState
+    {
+        SLOT_FREE,
+        SLOT_FILLING,
+        SLOT_READY,
+        SLOT_DONE
+    };
+
+    // Audio callback side
+    void ApplyTap();
+    void ApplyClear();
+    void CloseRecording();
+    void AcquireSlot();
+    void ReleaseSlot();
+
+    // Service side
+    void FillSlot(size_t slot, size_t chunk, uint32_t gen, uint32_t seq, bool read);
+    void WriteBack(size_t slot);
+    void SilenceChunk(size_t chunk);
+
+    LoopSample *storage = nullptr;
+    LoopBuffers *buffers = nullptr;
+
+    // Slot ownership and tags
+    volatile SlotState slotState[looperCacheChunks];
+    volatile bool slotDirty[looperCacheChunks];
+    volatile uint32_t slotGeneration[looperCacheChunks];
+    volatile uint32_t slotSequence[looperCacheChunks];
+    size_t slotChunk[looperCacheChunks];
+
+    // First sequence Service() has not filled a slot for yet, in fillGeneration
+    uint32_t fillGeneration = 0;
+    uint32_t fillSequence = 0;
+
+    // Loop state, written by the audio callback
+    volatile LoopState state = LOOP_EMPTY;
+    volatile uint32_t generation = 0;
+    volatile uint32_t sequence = 0;
+    volatile size_t loopLength = 0;
+    volatile size_t numChunks = 0;
+    size_t position = 0;
+    size_t chunkOffset = 0;
+    int activeSlot = -1;
+    volatile size_t underruns = 0;
+
+    // Set from the switch interrupts
+    volatile bool tapRequested = false;
+    volatile bool clearRequested = false;
+};
+
+#endif
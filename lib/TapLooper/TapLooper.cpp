@@ -0,0 +1,128 @@
+#include "TapLooper.h"
+
+// Loop storage, not cleared since every sample is recorded before it is played
+static LoopSample DSY_SDRAM_BSS looperStorage[looperStorageSize];
+
+// Head and chunk cache the callback plays from, in DTCM with the TCM layout, kept out of AXI SRAM otherwise
+static LoopBuffers DTCM_OR_SDRAM_BSS looperBuffers;
+
+// Initialize the looper
+void TapLooper::Setup(size_t pNumChannels)
+{
+    // Initialize the loop engine
+    recorder.Init(looperStorage, &looperBuffers);
+
+    // Initialize the switches
+    tapButton.Init(
+        looperTapButtonPin, INPUT, [this]() { return recorder.Tap(); }, RISING);
+    clearButton.Init(
+        looperClearButtonPin, INPUT, [this]() { return recorder.Clear(); }, RISING);
+
+    // Initialize the loop level
+    loopLevel.Init(loopLevelKnobPin, INPUT, loopLevelValue, minLoopLevelValue, maxLoopLevelValue);
+
+    // Initialize the LEDs
+    pinMode(recordingLedPin, OUTPUT);
+    pinMode(playingLedPin, OUTPUT);
+    pinMode(overdubbingLedPin, OUTPUT);
+    displayedState = LOOP_EMPTY;
+    UpdateLeds();
+}
+
+// Clean up the looper
+void TapLooper::Cleanup()
+{
+    tapButton.DetachInterrupt();
+    clearButton.DetachInterrupt();
+    recorder.Clear();
+
+    // Turn off the LEDs
+    displayedState = LOOP_EMPTY;
+    UpdateLeds();
+}
+
+// Audio callback when audio input occurs
+ITCM_FUNC void TapLooper::AudioCallback(float **in, float **out, size_t size)
+{
+#if BENCHMARK
+    callbackCycles.Start();
+#endif
+
+    for (size_t i = 0; i < size; i++)
+    {
+        float dry, loop;
+
+        // Read Dry from I/O
+        dry = in[AUDIO_IN_CH][i];
+
+        // Record, overdub or play the loop
+        loop = recorder.Process(dry);
+
+        // Mix Dry and Loop and send to I/O
+        out[AUDIO_OUT_CH][i] = ((loop * loopLevelValue) + dry);
+    }
+
+#if BENCHMARK
+    callbackCycles.Stop(size);
+#endif
+}
+
+// Logic for the looper to add into the main loop
+void TapLooper::Loop()
+{
+    // Stream chunks between the cache and SDRAM
+    recorder.Service();
+
+    // Update the loop level if the knob has been moved
+    if (loopLevel.SetNewValue(loopLevelValue))
+    {
+        debugPrint("Updated the loop level to: ");
+        debugPrintln(loopLevelValue);
+    }
+
+    // Show the loop state
+    if (recorder.GetState() != displayedState)
+    {
+        displayedState = recorder.GetState();
+        UpdateLeds();
+
+        debugPrint("Looper state: ");
+        debugPrint(displayedState);
+        debugPrint(", length: ");
+        debugPrintln(recorder.GetLoopLength());
+    }
+
+#if BENCHMARK
+    // Report the audio callback cost, reading and clearing the counter without the callback in between
+    if (DEBUG && (millis() - cpuReportTime > looperReportInterval))
+    {
+        __disable_irq();
+        float cyclesPerSample = callbackCycles.CyclesPerSample();
+        uint32_t worstCycles = callbackCycles.MaxCycles();
+        callbackCycles.Reset();
+        __enable_irq();
+
+        debugPrint("Audio callback cycles/sample: ");
+        debugPrint(cyclesPerSample);
+        debugPrint(", worst: ");
+        debugPrint(worstCycles);
+        debugPrint(", underruns: ");
+        debugPrintln(recorder.GetUnderruns());
+        cpuReportTime = millis();
+    }
+#endif
+}
+
+// Return the effect name (for debugging)
+String TapLooper::GetEffectName()
+{
+    return "TapLooper";
+}
+
+// Turn on the LED for the current state
+void TapLooper::UpdateLeds()
+{
+    analogWrite(recordingLedPin, (displayedState == LOOP_RECORDING) ? looperLedIntensity : 0);
+    analogWrite(playingLedPin, (displayedState == LOOP_PLAYING) ? looperLedIntensity : 0);
+    analogWrite(overdubbingLedPin, (displayedState == LOOP_OVERDUBBING) ? looperLedIntensity : 0);
+}
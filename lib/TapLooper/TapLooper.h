@@ -0,0 +1,82 @@
+#ifndef TAP_LOOPER_H
+#define TAP_LOOPER_H
+
+#include "DaisyDuino.h"
+#include "../../include/IEffect.h"
+#include "../../include/PedalConfig.h"
+#include "../Inputs/Knob.h"
+#include "../Inputs/Button.h"
+#include "../Utility/CycleCounter.h"
+#include "../Utility/MemoryPlacement.h"
+#include "LoopRecorder.h"
+
+/**********************************************
+ * Looper Effect
+ * 
+ * SPST 1 - Record/Play/Overdub
+ * SPST 2 - Clear
+ * SPST 3 - N/U
+ * SPST 4 - N/U
+ * 
+ * SPDT 1 - N/U
+ * SPDT 2 - N/U
+ * 
+ * Knob 1 - Loop Level
+ * Knob 2 - N/U
+ * Knob 3 - N/U
+ * Knob 4 - N/U
+ * 
+ * LED 1 - Recording
+ * LED 2 - Playing
+ * LED 3 - Overdubbing
+ * LED 4 - N/U
+ **********************************************/
+
+// Pin renaming
+static const int looperTapButtonPin = effectSPSTPin4;
+static const int looperClearButtonPin = effectSPSTPin3;
+static const int loopLevelKnobPin = effectPotPin4;
+static const int recordingLedPin = effectLedPin1;
+static const int playingLedPin = effectLedPin2;
+static const int overdubbingLedPin = effectLedPin3;
+
+// Constant parameters
+static const size_t looperLedIntensity = 128;
+static const unsigned long looperReportInterval = 1000;
+
+// Level constants
+static const float minLoopLevelValue = 1.0f;
+static const float maxLoopLevelValue = 0.0f;
+
+class TapLooper : public IEffect
+{
+public:
+    void Setup(size_t pNumChannels);
+    void Cleanup();
+    void AudioCallback(float **in, float **out, size_t size);
+    void Loop();
+    String GetEffectName();
+
+private:
+    void UpdateLeds();
+
+    // Input handlers
+    Button tapButton;
+    Button clearButton;
+    Knob loopLevel;
+
+    // Mutable parameters
+    float loopLevelValue = 1.0f;
+    LoopState displayedState = LOOP_EMPTY;
+
+    // Loop engine
+    LoopRecorder recorder;
+
+#if BENCHMARK
+    // CPU usage, only measured in benchmark builds
+    CycleCounter callbackCycles;
+    unsigned long cpuReportTime = 0;
+#endif
+};
+
+#endif
@@ -0,0 +1,32 @@
+#include "CycleCounter.h"
+
+void CycleCounter::Enable()
+{
+    // Turn on the trace unit, unlock the DWT (required on the M7) and start the counter
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+void CycleCounter::Reset()
+{
+    maxCycles = 0;
+    totalCycles = 0;
+    totalSamples = 0;
+}
+
+float CycleCounter::CyclesPerSample()
+{
+    if (totalSamples == 0)
+    {
+        return 0.0f;
+    }
+
+    return (float)totalCycles / (float)totalSamples;
+}
+
+uint32_t CycleCounter::MaxCycles()
+{
+    return maxCycles;
+}
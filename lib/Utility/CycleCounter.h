@@ -0,0 +1,64 @@
+#ifndef CYCLE_COUNTER_H
+#define CYCLE_COUNTER_H
+
+#include "DaisyDuino.h"
+
+/**
+ * Measures CPU cycles spent in a section of code using the Cortex-M7 DWT cycle counter
+ * Used to budget audio callback cost per sample
+ */
+class CycleCounter
+{
+public:
+    /**
+     * Enables the DWT cycle counter, must be called once before any measurement
+     */
+    static void Enable();
+
+    /**
+     * Marks the start of the measured section
+     */
+    inline void Start()
+    {
+        startCycles = DWT->CYCCNT;
+    }
+
+    /**
+     * Marks the end of the measured section
+     * @param samples Number of samples processed by the section
+     */
+    inline void Stop(size_t samples)
+    {
+        uint32_t elapsed = DWT->CYCCNT - startCycles;
+
+        totalCycles += elapsed;
+        totalSamples += samples;
+        if (elapsed > maxCycles)
+        {
+            maxCycles = elapsed;
+        }
+    }
+
+    /**
+     * Clears the accumulated measurements
+     */
+    void Reset();
+
+    /**
+     * @return Average cycles spent per processed sample
+     */
+    float CyclesPerSample();
+
+    /**
+     * @return Longest single measurement in cycles
+     */
+    uint32_t MaxCycles();
+
+private:
+    uint32_t startCycles = 0;
+    uint32_t maxCycles = 0;
+    uint64_t totalCycles = 0;
+    uint64_t totalSamples = 0;
+};
+
+#endif
@@ -0,0 +1,54 @@
+#include "MemoryPlacement.h"
+#include "../../include/PedalConfig.h"
+#include <string.h>
+
+#if defined(ARDUINO) && defined(TCM_PLACEMENT)
+
+// Section boundaries exported by linker/daisy_seed_tcm.ld
+extern uint32_t _siitcm_text;
+extern uint32_t _sitcm_text;
+extern uint32_t _eitcm_text;
+extern uint32_t _sidtcm_data;
+extern uint32_t _sdtcm_data;
+extern uint32_t _edtcm_data;
+extern uint32_t _sdtcm_bss;
+extern uint32_t _edtcm_bss;
+
+static void InitMemoryPlacement()
+{
+    // Copy the ITCM code from its load address in flash
+    memcpy(&_sitcm_text, &_siitcm_text, (size_t)((char *)&_eitcm_text - (char *)&_sitcm_text));
+
+    // Copy the initialized DTCM data and clear the DTCM bss
+    memcpy(&_sdtcm_data, &_sidtcm_data, (size_t)((char *)&_edtcm_data - (char *)&_sdtcm_data));
+    memset(&_sdtcm_bss, 0, (size_t)((char *)&_edtcm_bss - (char *)&_sdtcm_bss));
+
+    // Make sure the copied code is visible before anything branches into it
+    __DSB();
+    __ISB();
+}
+
+// __libc_init_array runs the .preinit_array before any constructor, including the framework's
+// priority ones, so the effect objects placed in DTCM are constructed on cleared memory
+__attribute__((section(".preinit_array"), used)) static void (*const initMemoryPlacementEntry)() = InitMemoryPlacement;
+
+void ReportMemoryPlacement()
+{
+    size_t itcmBytes = (size_t)((char *)&_eitcm_text - (char *)&_sitcm_text);
+    size_t dtcmBytes = (size_t)((char *)&_edtcm_data - (char *)&_sdtcm_data) + (size_t)((char *)&_edtcm_bss - (char *)&_sdtcm_bss);
+
+    debugPrint("ITCM used: ");
+    debugPrint(itcmBytes);
+    debugPrint(" bytes, DTCM used: ");
+    debugPrint(dtcmBytes);
+    debugPrintln(" bytes");
+}
+
+#else
+
+void ReportMemoryPlacement()
+{
+    // Nothing is placed on host builds or with the stock layout
+}
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef MEMORY_PLACEMENT_H
+#define MEMORY_PLACEMENT_H
+
+#include "DaisyDuino.h"
+
+/**********************************************
+ * Memory Placement
+ *
+ * The sections below are laid out by linker/daisy_seed_tcm.ld
+ *
+ * ITCM  (0x00000000,  64KB) - zero wait state code, audio callback chain
+ * DTCM  (0x20000000, 128KB) - zero wait state data, hot DSP state
+ * AXI   (0x24000000, 512KB) - default .data/.bss, heap and stack
+ * D2    (0x30000000, 288KB) - DMA buffers
+ * SDRAM (0xC0000000,  64MB) - large buffers (DSY_SDRAM_BSS)
+ *
+ * TCM contents are copied and cleared from a .preinit_array entry, which runs
+ * before every constructor, so objects placed in DTCM are constructed after their memory is ready.
+ * DTCM is not reachable by the DMA controllers, never place DMA buffers there.
+ *
+ * The placement is opt-in through the electrosmith_daisy_tcm environment, which links
+ * the script above and defines TCM_PLACEMENT. It has to pass a target link and a boot
+ * check on a Seed before it replaces the default environment, until then the default
+ * build keeps the stock DaisyDuino layout and the macros below place nothing, except
+ * DTCM_OR_SDRAM_BSS and AXI_OR_SDRAM_NOINIT, which keep the larger effect buffers out of AXI SRAM.
+ **********************************************/
+
+#if defined(ARDUINO) && defined(TCM_PLACEMENT)
+#define MEMORY_SECTION(name) __attribute__((section(name)))
+#else
+// Host builds (sim/) and the stock layout have no TCM sections, everything stays in the default sections
+#define MEMORY_SECTION(name)
+#endif
+
+/**
+ * Places a function in ITCM, use on the audio callback and the functions it calls
+ * GCC ignores this on template members, those are placed by name in the linker script
+ */
+#define ITCM_FUNC MEMORY_SECTION(".itcm_text")
+
+/**
+ * Places an initialized variable in DTCM
+ */
+#define DTCM_DATA MEMORY_SECTION(".dtcm_data")
+
+/**
+ * Places a zero initialized variable or object in DTCM
+ */
+#define DTCM_BSS MEMORY_SECTION(".dtcm_bss")
+
+/**
+ * Places a large buffer in DTCM with the TCM layout and in SDRAM with the stock layout
+ * SDRAM is not cleared and is only ready once DAISY.init() has run, so only types with no
+ * constructor or default member initializers can be placed here, set up in Setup()
+ */
+#if defined(ARDUINO) && defined(TCM_PLACEMENT)
+#define DTCM_OR_SDRAM_BSS DTCM_BSS
+#else
+#define DTCM_OR_SDRAM_BSS DSY_SDRAM_BSS
+#endif
+
+/**
+ * Places a variable in AXI SRAM without clearing it at boot, for buffers that track their own valid range
+ * The memory is not zeroed, so objects placed here must set all of their members in Init()
+ */
+#define AXI_NOINIT MEMORY_SECTION(".noinit")
+
+/**
+ * Places a large buffer that is not cleared at boot, in AXI SRAM with the TCM layout and in SDRAM with the stock layout
+ * The stock layout has no .noinit section and its startup code zeroes all of .bss, SDRAM is never cleared
+ */
+#if defined(ARDUINO) && defined(TCM_PLACEMENT)
+#define AXI_OR_SDRAM_NOINIT AXI_NOINIT
+#else
+#define AXI_OR_SDRAM_NOINIT DSY_SDRAM_BSS
+#endif
+
+/**
+ * Prints the size of the ITCM and DTCM sections to the debug output
+ */
+void ReportMemoryPlacement();
+
+#endif
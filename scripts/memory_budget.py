@@ -0,0 +1,260 @@
+"""
+Memory budget report for the DaisyPedal firmware
+
+Runs as a PlatformIO extra script. Adds -Wl,-Map to the link, then parses the map
+file after every link and prints how much of each memory region every library
+(effect) uses. The build fails when a region or an effect is over its budget.
+
+Can also be run by hand: python scripts/memory_budget.py path/to/firmware.map
+"""
+
+import re
+import sys
+
+# Memory regions of the STM32H750 as laid out by linker/daisy_seed_tcm.ld
+REGIONS = [
+    ("ITCM", 0x00000000, 64 * 1024),
+    ("FLASH", 0x08000000, 128 * 1024),
+    ("DTCM", 0x20000000, 128 * 1024),
+    ("AXI", 0x24000000, 512 * 1024),
+    ("D2", 0x30000000, 288 * 1024),
+    ("D3", 0x38000000, 64 * 1024),
+    ("SDRAM", 0xC0000000, 64 * 1024 * 1024),
+]
+
+# Budget per region, kept under the physical size to leave room for growth
+REGION_BUDGETS = {
+    "ITCM": 48 * 1024,
+    "FLASH": 120 * 1024,
+    "DTCM": 120 * 1024,
+    "AXI": 500 * 1024,
+    "D2": 288 * 1024,
+    "D3": 64 * 1024,
+    "SDRAM": 64 * 1024 * 1024,
+}
+
+# Budget per effect library in the hot regions and in AXI SRAM
+# SingleEcho DTCM: the effect object (about 7K, 2K of it the output limiter) plus the 4K grain window table
+# SingleEcho AXI: the 375K delay line with the TCM layout (.noinit), with the stock layout it is in SDRAM
+# and AXI only holds the DTCM part
+# CabSim and TapLooper keep their convolver (66K) and loop buffers (24K) in DTCM with the TCM layout
+# and in SDRAM with the stock layout (DTCM_OR_SDRAM_BSS), so only their small objects may use AXI
+EFFECT_BUDGETS = {
+    "SingleEcho": {"ITCM": 8 * 1024, "DTCM": 16 * 1024, "AXI": 392 * 1024},
+    "CabSim": {"ITCM": 8 * 1024, "DTCM": 72 * 1024, "AXI": 2 * 1024},
+    "Reverb": {"ITCM": 4 * 1024, "DTCM": 4 * 1024, "AXI": 2 * 1024},
+    "TapLooper": {"ITCM": 4 * 1024, "DTCM": 32 * 1024, "AXI": 2 * 1024},
+}
+
+# Effect objects defined in include/EffectType.h, attributed to their effect instead of main
+EFFECT_OBJECTS = {
+    "singleEcho": "SingleEcho",
+    "cabSim": "CabSim",
+    "reverb": "Reverb",
+    "tapLooper": "TapLooper",
+}
+
+# Input section line, the name may be on the line before when it is long
+INPUT_SECTION = re.compile(r"^ (\S+)?\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+SYMBOL = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+([A-Za-z_][A-Za-z0-9_:]*)$")
+OUTPUT_SECTION = re.compile(r"^(\.\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)")
+
+# Sections that never end up in memory
+IGNORED_SECTIONS = (".ARM.attributes", ".comment", ".debug", ".stab")
+
+
+def region_of(address):
+    for name, origin, length in REGIONS:
+        if origin <= address < origin + length:
+            return name
+    return None
+
+
+def owner_of(path):
+    """Maps an object file in the map to the library or folder it came from"""
+    path = path.replace("\\", "/")
+    match = re.search(r"lib([A-Za-z0-9_]+)\.a\(", path)
+    if match:
+        return match.group(1)
+    match = re.search(r"/lib[0-9a-fA-F]*/([A-Za-z0-9_]+)/", path)
+    if match:
+        return match.group(1)
+    if "/src/" in path:
+        return "main"
+    if "linker stubs" in path or path.startswith("*"):
+        return "linker"
+    return "framework"
+
+
+def add_usage(usage, owner, region, size):
+    regions = usage.setdefault(owner, {})
+    regions[region] = regions.get(region, 0) + size
+
+
+def flush_section(usage, section):
+    """Adds a finished input section, splitting out the effect objects defined in main"""
+    if section is None:
+        return
+
+    owner, region, address, size, symbols = section
+    section_end = address + size
+    if owner == "main" and symbols:
+        symbols.sort()
+        for i, (symbol_address, symbol) in enumerate(symbols):
+            effect = EFFECT_OBJECTS.get(symbol)
+            if effect is None:
+                continue
+            end = symbols[i + 1][0] if i + 1 < len(symbols) else section_end
+            add_usage(usage, effect, region, end - symbol_address)
+            size -= end - symbol_address
+
+    if size > 0:
+        add_usage(usage, owner, region, size)
+
+
+def parse_map(map_path):
+    """Returns {owner: {region: bytes}} and {region: bytes} from a GNU ld map file"""
+    usage = {}
+    totals = {}
+
+    with open(map_path, "r", errors="replace") as map_file:
+        lines = map_file.read().splitlines()
+
+    # Only the memory map part lists the placed sections
+    try:
+        start = next(i for i, line in enumerate(lines) if line.startswith("Linker script and memory map"))
+    except StopIteration:
+        raise RuntimeError("No memory map found in " + map_path)
+
+    output_section = None
+    input_section = None
+    pending_name = None
+    for line in lines[start:]:
+        match = OUTPUT_SECTION.match(line)
+        if match:
+            flush_section(usage, input_section)
+            input_section = None
+            output_section = match.group(1)
+            address = int(match.group(2), 16)
+            size = int(match.group(3), 16)
+            region = region_of(address)
+            if region and size and not output_section.startswith(IGNORED_SECTIONS):
+                totals[region] = totals.get(region, 0) + size
+
+                # Initialized TCM and RAM sections also take their load image in flash
+                load = re.search(r"load address 0x([0-9a-fA-F]+)", line)
+                if load and region_of(int(load.group(1), 16)) == "FLASH":
+                    totals["FLASH"] = totals.get("FLASH", 0) + size
+            pending_name = None
+            continue
+
+        if output_section is None or output_section.startswith(IGNORED_SECTIONS):
+            continue
+
+        # Symbols defined in the current input section
+        match = SYMBOL.match(line)
+        if match and input_section is not None:
+            input_section[4].append((int(match.group(1), 16), match.group(2)))
+            continue
+
+        # Long input section names are printed alone on their own line
+        if re.match(r"^ \.\S+$", line) or re.match(r"^ COMMON$", line):
+            pending_name = line.strip()
+            continue
+
+        match = INPUT_SECTION.match(line)
+        if not match or (match.group(1) is None and pending_name is None) or (match.group(1) or "").startswith("*"):
+            pending_name = None
+            continue
+        pending_name = None
+
+        flush_section(usage, input_section)
+        input_section = None
+
+        address = int(match.group(2), 16)
+        size = int(match.group(3), 16)
+        region = region_of(address)
+        if region is None or size == 0:
+            continue
+
+        input_section = (owner_of(match.group(4)), region, address, size, [])
+
+    flush_section(usage, input_section)
+    return usage, totals
+
+
+def format_bytes(size):
+    if size >= 1024 * 1024:
+        return "%.1fM" % (size / (1024.0 * 1024.0))
+    if size >= 1024:
+        return "%.1fK" % (size / 1024.0)
+    return "%dB" % size
+
+
+def report(map_path):
+    """Prints the placement report, returns the list of budget violations"""
+    usage, totals = parse_map(map_path)
+    errors = []
+    region_names = [name for name, _, _ in REGIONS]
+
+    print("")
+    print("Memory placement per library")
+    print("%-20s" % "" + "".join("%10s" % name for name in region_names))
+    for owner in sorted(usage):
+        row = "%-20s" % owner
+        for region in region_names:
+            size = usage[owner].get(region, 0)
+            row += "%10s" % (format_bytes(size) if size else "-")
+        print(row)
+
+    print("")
+    print("Region usage and headroom")
+    for region in region_names:
+        used = totals.get(region, 0)
+        budget = REGION_BUDGETS[region]
+        print("%-8s %10s used of %10s budget, %10s headroom" % (region, format_bytes(used), format_bytes(budget), format_bytes(budget - used)))
+        if used > budget:
+            errors.append("%s uses %s, over its %s budget" % (region, format_bytes(used), format_bytes(budget)))
+
+    print("")
+    print("Effect headroom")
+    for effect in sorted(EFFECT_BUDGETS):
+        for region, budget in sorted(EFFECT_BUDGETS[effect].items()):
+            used = usage.get(effect, {}).get(region, 0)
+            print("%-12s %-6s %10s used of %10s budget, %10s headroom" % (effect, region, format_bytes(used), format_bytes(budget), format_bytes(budget - used)))
+            if used > budget:
+                errors.append("%s uses %s of %s, over its %s budget" % (effect, format_bytes(used), region, format_bytes(budget)))
+
+    print("")
+    return errors
+
+
+def main(map_path):
+    errors = report(map_path)
+    for error in errors:
+        print("Memory budget exceeded: " + error)
+    return 1 if errors else 0
+
+
+try:
+    Import("env")  # noqa: F821 (provided by PlatformIO)
+except NameError:
+    env = None
+
+if env is not None:
+    map_file = "$BUILD_DIR/${PROGNAME}.map"
+    env.Append(LINKFLAGS=["-Wl,-Map," + map_file])
+
+    def memory_budget_action(source, target, env):
+        errors = report(env.subst(map_file))
+        if errors:
+            for error in errors:
+                sys.stderr.write("Memory budget exceeded: " + error + "\n")
+            env.Exit(1)
+
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", memory_budget_action)
+elif __name__ == "__main__":
+    if len(sys.argv) != 2:
+        print("usage: memory_budget.py firmware.map")
+        sys.exit(2)
+    sys.exit(main(sys.argv[1]))
@@ -0,0 +1,256 @@
+#include "DeadlineMonitor.h"
+#include <stdio.h>
+#include <string.h>
+
+// Most events printed around a single miss
+static const size_t monitorMaxContextEvents = 64;
+
+void DeadlineMonitor::Init(uint64_t pPeriodNs, uint64_t pWindowNs, size_t pMaxReports)
+{
+    periodNs = pPeriodNs;
+    windowNs = pWindowNs;
+    maxReports = pMaxReports;
+    reported = 0;
+
+    for (size_t i = 0; i < monitorLogSize; i++)
+    {
+        log[i].sequence = 0;
+    }
+    logHead = 0;
+    missHead = 0;
+    missTail = 0;
+    misses = 0;
+    droppedReports = 0;
+
+    blocks = 0;
+    totalExecNs = 0;
+    maxExecNs = 0;
+    maxLatenessNs = 0;
+    memset(histogram, 0, sizeof(histogram));
+}
+
+void DeadlineMonitor::Log(SimEventType type, uint64_t timeNs, uint64_t durationNs, int pin, int value)
+{
+    // Claim a slot, mark it as being written, fill it, then publish it
+    uint64_t index = logHead.fetch_add(1);
+    Slot &slot = log[index & (monitorLogSize - 1)];
+    slot.sequence.store(0, std::memory_order_release);
+    slot.event.timeNs = timeNs;
+    slot.event.durationNs = durationNs;
+    slot.event.type = type;
+    slot.event.pin = pin;
+    slot.event.value = value;
+    slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+void DeadlineMonitor::RecordCallback(uint64_t scheduledNs, uint64_t startNs, uint64_t endNs)
+{
+    uint64_t execNs = endNs - startNs;
+    uint64_t latenessNs = (startNs > scheduledNs) ? (startNs - scheduledNs) : 0;
+
+    blocks++;
+    totalExecNs += execNs;
+    if (execNs > maxExecNs)
+    {
+        maxExecNs = execNs;
+    }
+    if (latenessNs > maxLatenessNs)
+    {
+        maxLatenessNs = latenessNs;
+    }
+
+    size_t bin = (size_t)(execNs / monitorHistogramBinNs);
+    histogram[(bin < monitorHistogramBins) ? bin : (monitorHistogramBins - 1)]++;
+
+    // The next block is due one period after this one was scheduled
+    if (endNs <= scheduledNs + periodNs)
+    {
+        return;
+    }
+
+    misses++;
+    Log(EVENT_MISS, scheduledNs, endNs - startNs, -1, (int)((endNs - (scheduledNs + periodNs)) / 1000));
+
+    uint64_t head = missHead.load(std::memory_order_relaxed);
+    if (head - missTail.load(std::memory_order_acquire) >= monitorMissQueueSize)
+    {
+        droppedReports++;
+        return;
+    }
+
+    Miss &miss = missQueue[head & (monitorMissQueueSize - 1)];
+    miss.block = blocks - 1;
+    miss.scheduledNs = scheduledNs;
+    miss.startNs = startNs;
+    miss.endNs = endNs;
+    missHead.store(head + 1, std::memory_order_release);
+}
+
+void DeadlineMonitor::Service(uint64_t nowNs)
+{
+    uint64_t tail = missTail.load(std::memory_order_relaxed);
+    while (tail != missHead.load(std::memory_order_acquire))
+    {
+        const Miss &miss = missQueue[tail & (monitorMissQueueSize - 1)];
+
+        // Wait until the events after the miss have been logged
+        if (nowNs < miss.endNs + windowNs)
+        {
+            break;
+        }
+
+        if (reported < maxReports)
+        {
+            PrintMiss(miss);
+            reported++;
+        }
+
+        tail++;
+        missTail.store(tail, std::memory_order_release);
+    }
+}
+
+void DeadlineMonitor::PrintSummary()
+{
+    // Percentiles from the histogram
+    uint64_t p99Ns = 0;
+    uint64_t p999Ns = 0;
+    uint64_t count = 0;
+    for (size_t bin = 0; bin < monitorHistogramBins; bin++)
+    {
+        count += histogram[bin];
+        if (p99Ns == 0 && count * 100 >= blocks * 99)
+        {
+            p99Ns = (bin + 1) * monitorHistogramBinNs;
+        }
+        if (p999Ns == 0 && count * 1000 >= blocks * 999)
+        {
+            p999Ns = (bin + 1) * monitorHistogramBinNs;
+        }
+    }
+
+    printf("\nCallbacks: %llu, period %.2fus\n", (unsigned long long)blocks, (double)periodNs / 1000.0);
+    printf("Execution: mean %.2fus, p99 < %.1fus, p99.9 < %.1fus, worst %.2fus (%.0f%% of the period)\n",
+           blocks ? ((double)totalExecNs / (double)blocks) / 1000.0 : 0.0,
+           (double)p99Ns / 1000.0, (double)p999Ns / 1000.0, (double)maxExecNs / 1000.0,
+           periodNs ? (100.0 * (double)maxExecNs / (double)periodNs) : 0.0);
+    printf("Start jitter: worst %.2fus\n", (double)maxLatenessNs / 1000.0);
+    printf("Missed deadlines: %llu (%zu reported", (unsigned long long)misses.load(), reported);
+    if (droppedReports > 0)
+    {
+        printf(", %llu dropped", (unsigned long long)droppedReports.load());
+    }
+    printf(")\n");
+}
+
+uint64_t DeadlineMonitor::GetMisses()
+{
+    return misses;
+}
+
+void DeadlineMonitor::PrintMiss(const Miss &miss)
+{
+    printf("\nMissed deadline at block %llu, t=%.3fms: started %.2fus late, ran %.2fus, finished %.2fus past the deadline\n",
+           (unsigned long long)miss.block, (double)miss.scheduledNs / 1e6,
+           (double)(miss.startNs - miss.scheduledNs) / 1000.0, (double)(miss.endNs - miss.startNs) / 1000.0,
+           (double)(miss.endNs - (miss.scheduledNs + periodNs)) / 1000.0);
+
+    SimEvent events[monitorMaxContextEvents];
+    uint64_t fromNs = (miss.scheduledNs > windowNs) ? (miss.scheduledNs - windowNs) : 0;
+    size_t count = CollectEvents(fromNs, miss.endNs + windowNs, events, monitorMaxContextEvents);
+
+    size_t printed = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        const SimEvent &event = events[i];
+        if (event.type == EVENT_MISS && event.timeNs == miss.scheduledNs)
+        {
+            continue;
+        }
+        printed++;
+
+        double offsetUs = ((double)event.timeNs - (double)miss.scheduledNs) / 1000.0;
+        printf("  %+10.2fus %-6s", offsetUs, EventName(event.type));
+        if (event.pin >= 0)
+        {
+            printf(" pin %d value %d", event.pin, event.value);
+        }
+        if (event.durationNs > 0)
+        {
+            printf(" took %.2fus", (double)event.durationNs / 1000.0);
+        }
+        printf("\n");
+    }
+
+    if (printed == 0)
+    {
+        printf("  no control events within %.0fus\n", (double)windowNs / 1000.0);
+    }
+}
+
+size_t DeadlineMonitor::CollectEvents(uint64_t fromNs, uint64_t toNs, SimEvent *events, size_t maxEvents)
+{
+    uint64_t head = logHead.load(std::memory_order_acquire);
+    uint64_t first = (head > monitorLogSize) ? (head - monitorLogSize) : 0;
+    size_t count = 0;
+
+    for (uint64_t index = first; index < head; index++)
+    {
+        Slot &slot = log[index & (monitorLogSize - 1)];
+
+        // Skip slots that are being written or have been reused since
+        if (slot.sequence.load(std::memory_order_acquire) != index + 1)
+        {
+            continue;
+        }
+        SimEvent event = slot.event;
+        if (slot.sequence.load(std::memory_order_acquire) != index + 1)
+        {
+            continue;
+        }
+
+        // Events that overlap the window, loops and interrupts are logged when they finish
+        if (event.timeNs + event.durationNs < fromNs || event.timeNs > toNs)
+        {
+            continue;
+        }
+
+        // Keep the most recent ones when there are too many, they are closest to the miss
+        if (count == maxEvents)
+        {
+            memmove(&events[0], &events[1], sizeof(SimEvent) * (maxEvents - 1));
+            count--;
+        }
+
+        // Insert sorted by time, producers on different threads log out of order
+        size_t position = count;
+        while (position > 0 && events[position - 1].timeNs > event.timeNs)
+        {
+            events[position] = events[position - 1];
+            position--;
+        }
+        events[position] = event;
+        count++;
+    }
+
+    return count;
+}
+
+const char *DeadlineMonitor::EventName(SimEventType type)
+{
+    switch (type)
+    {
+    case EVENT_LOOP:
+        return "loop";
+    case EVENT_ISR:
+        return "isr";
+    case EVENT_KNOB:
+        return "knob";
+    case EVENT_SWITCH:
+        return "switch";
+    case EVENT_MISS:
+        return "miss";
+    default:
+        return "?";
+    }
+}
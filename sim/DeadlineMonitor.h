@@ -0,0 +1,128 @@
+#ifndef DEADLINE_MONITOR_H
+#define DEADLINE_MONITOR_H
+
+#include <atomic>
+#include <stdint.h>
+#include <stddef.h>
+
+// Event log size, must be a power of two and hold well over one report window of events
+static const size_t monitorLogSize = 1 << 16;
+static const size_t monitorMissQueueSize = 1 << 10;
+
+// Execution time histogram, 100ns bins up to 1ms
+static const size_t monitorHistogramBins = 10000;
+static const uint64_t monitorHistogramBinNs = 100;
+
+/**
+ * Types of control events recorded next to the audio deadlines
+ */
+enum SimEventType
+{
+    EVENT_LOOP,
+    EVENT_ISR,
+    EVENT_KNOB,
+    EVENT_SWITCH,
+    EVENT_MISS
+};
+
+/**
+ * One control event, durationNs is 0 for instantaneous events
+ */
+struct SimEvent
+{
+    uint64_t timeNs;
+    uint64_t durationNs;
+    SimEventType type;
+    int pin;
+    int value;
+};
+
+/**
+ * Tracks the audio callback deadlines and logs the control activity around them
+ *
+ * The real-time thread reports every callback with RecordCallback(), any thread logs control events
+ * with Log() into a lock free ring, and a reporter thread calls Service() to print each missed deadline
+ * with the events within the report window on either side of it, once the window has passed.
+ */
+class DeadlineMonitor
+{
+public:
+    /**
+     * @param pPeriodNs Callback period (BLOCKSIZE / sample rate)
+     * @param pWindowNs Events this far before and after a miss are printed with it
+     * @param pMaxReports Misses past this count are only counted
+     */
+    void Init(uint64_t pPeriodNs, uint64_t pWindowNs, size_t pMaxReports);
+
+    /**
+     * Logs a control event, safe from any thread
+     */
+    void Log(SimEventType type, uint64_t timeNs, uint64_t durationNs, int pin, int value);
+
+    /**
+     * Reports one audio callback, real-time thread only
+     * @param scheduledNs Time the callback was due to start
+     * @param startNs Time it started
+     * @param endNs Time it returned, a miss if later than scheduledNs + period
+     */
+    void RecordCallback(uint64_t scheduledNs, uint64_t startNs, uint64_t endNs);
+
+    /**
+     * Prints the misses whose report window has passed, reporter thread only
+     */
+    void Service(uint64_t nowNs);
+
+    /**
+     * Prints the callback timing statistics, call after the real-time thread has stopped
+     */
+    void PrintSummary();
+
+    /**
+     * @return Number of missed deadlines so far
+     */
+    uint64_t GetMisses();
+
+private:
+    struct Slot
+    {
+        std::atomic<uint64_t> sequence;
+        SimEvent event;
+    };
+
+    struct Miss
+    {
+        uint64_t block;
+        uint64_t scheduledNs;
+        uint64_t startNs;
+        uint64_t endNs;
+    };
+
+    void PrintMiss(const Miss &miss);
+    size_t CollectEvents(uint64_t fromNs, uint64_t toNs, SimEvent *events, size_t maxEvents);
+    static const char *EventName(SimEventType type);
+
+    uint64_t periodNs = 0;
+    uint64_t windowNs = 0;
+    size_t maxReports = 0;
+    size_t reported = 0;
+
+    // Event ring, slot sequence is index + 1 once the event is complete
+    Slot log[monitorLogSize];
+    std::atomic<uint64_t> logHead{0};
+
+    // Misses waiting for their window to pass, single producer (real-time thread), single consumer
+    Miss missQueue[monitorMissQueueSize];
+    std::atomic<uint64_t> missHead{0};
+    std::atomic<uint64_t> missTail{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> droppedReports{0};
+
+    // Callback statistics, written by the real-time thread only
+    uint64_t blocks = 0;
+    uint64_t totalExecNs = 0;
+    uint64_t maxExecNs = 0;
+    uint64_t maxLatenessNs = 0;
+    uint32_t histogram[monitorHistogramBins];
+};
+
+#endif
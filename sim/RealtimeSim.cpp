@@ -0,0 +1,387 @@
+/**********************************************
+ * Host Real-Time Simulator
+ *
+ * Runs one effect on the host with the same threads of control as the pedal:
+ *  - Audio: a dedicated thread calls the audio callback every BLOCKSIZE / DAISY.get_samplerate(),
+ *    spinning on absolute deadlines, and reports every block to the DeadlineMonitor
+ *  - Loop: a second thread runs IEffect::Loop() back to back, like loop() in main.cpp
+ *  - Controls: the main thread moves knobs, presses the tap button (firing its interrupt)
+ *    and flips a switch on a schedule, and prints each missed deadline with the events around it
+ *
+ * Audio and button interrupts share one lock (also taken by __disable_irq()) since they cannot
+ * run at the same time on the single core. Loop() runs truly in parallel here, where the hardware
+ * would preempt it, so shared state races show up at least as often as on the pedal.
+ *
+ * Exits with 1 if any deadline was missed.
+ **********************************************/
+
+// The unit tests under test/ link the rest of sim/ for the shims and bring their own main()
+#ifndef PIO_UNIT_TESTING
+
+#include <atomic>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+#include "SimHardware.h"
+#include "DeadlineMonitor.h"
+#include "EffectType.h"
+#include "PedalConfig.h"
+
+// Simulation defaults
+static const double simDefaultSeconds = 10.0;
+static const unsigned long simDefaultKnobMs = 250;
+static const unsigned long simDefaultTapMs = 600;
+static const unsigned long simDefaultSwitchMs = 4000;
+static const unsigned long simDefaultWindowUs = 500;
+static const unsigned long simDefaultLoopLogUs = 20;
+static const size_t simDefaultMaxReports = 20;
+
+// Input signal, a plucked note repeating every simNoteMs
+static const float simInputFrequency = 220.0f;
+static const float simInputLevel = 0.5f;
+static const unsigned long simNoteMs = 1000;
+
+// How long the tap button is held down
+static const unsigned long simButtonHoldMs = 50;
+
+struct SimOptions
+{
+    EffectType effect = SINGLEECHO;
+    double seconds = simDefaultSeconds;
+    unsigned long knobMs = simDefaultKnobMs;
+    unsigned long tapMs = simDefaultTapMs;
+    unsigned long switchMs = simDefaultSwitchMs;
+    unsigned long windowUs = simDefaultWindowUs;
+    unsigned long loopLogUs = simDefaultLoopLogUs;
+    size_t maxReports = simDefaultMaxReports;
+    bool realtimePriority = false;
+};
+
+static IEffect *currentEffect;
+static DeadlineMonitor monitor;
+static std::atomic<bool> running(true);
+
+// Written by the audio thread, read after it has stopped
+static uint64_t skippedBlocks = 0;
+static float outputPeak = 0.0f;
+static uint64_t nonFiniteSamples = 0;
+
+// Written by the loop thread, read after it has stopped
+static uint64_t loopIterations = 0;
+static uint64_t worstLoopNs = 0;
+
+static void PrintUsage()
+{
+    printf("Usage: realtime_sim [options]\n");
+    printf("  --effect <n>        effect to run (0 SingleEcho, 1 CabSim, 2 TapLooper, 3 Reverb)\n");
+    printf("  --seconds <s>       length of the run (default %.0f)\n", simDefaultSeconds);
+    printf("  --knob-ms <ms>      move a random knob this often, 0 to disable (default %lu)\n", simDefaultKnobMs);
+    printf("  --tap-ms <ms>       press the tap button this often, 0 to disable (default %lu)\n", simDefaultTapMs);
+    printf("  --switch-ms <ms>    flip SPST 3 this often, 0 to disable (default %lu)\n", simDefaultSwitchMs);
+    printf("  --window-us <us>    events printed before and after each miss (default %lu)\n", simDefaultWindowUs);
+    printf("  --loop-log-us <us>  log loop iterations longer than this (default %lu)\n", simDefaultLoopLogUs);
+    printf("  --reports <n>       misses printed in detail (default %zu)\n", simDefaultMaxReports);
+    printf("  --rt                run the audio thread with SCHED_FIFO priority (Linux, needs privileges)\n");
+}
+
+static bool ParseOptions(int argc, char **argv, SimOptions &options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+        if (strcmp(arg, "--rt") == 0)
+        {
+            options.realtimePriority = true;
+            continue;
+        }
+        if (value == nullptr)
+        {
+            return false;
+        }
+
+        if (strcmp(arg, "--effect") == 0)
+        {
+            options.effect = (EffectType)atoi(value);
+        }
+        else if (strcmp(arg, "--seconds") == 0)
+        {
+            options.seconds = atof(value);
+        }
+        else if (strcmp(arg, "--knob-ms") == 0)
+        {
+            options.knobMs = strtoul(value, nullptr, 10);
+        }
+        else if (strcmp(arg, "--tap-ms") == 0)
+        {
+            options.tapMs = strtoul(value, nullptr, 10);
+        }
+        else if (strcmp(arg, "--switch-ms") == 0)
+        {
+            options.switchMs = strtoul(value, nullptr, 10);
+        }
+        else if (strcmp(arg, "--window-us") == 0)
+        {
+            options.windowUs = strtoul(value, nullptr, 10);
+        }
+        else if (strcmp(arg, "--loop-log-us") == 0)
+        {
+            options.loopLogUs = strtoul(value, nullptr, 10);
+        }
+        else if (strcmp(arg, "--reports") == 0)
+        {
+            options.maxReports = (size_t)strtoul(value, nullptr, 10);
+        }
+        else
+        {
+            return false;
+        }
+        i++;
+    }
+
+    return options.seconds > 0.0;
+}
+
+static void SimAudioCallback(float **in, float **out, size_t size)
+{
+    currentEffect->AudioCallback(in, out, size);
+}
+
+/**
+ * Calls the audio callback on absolute deadlines, one block per period
+ */
+static void AudioThread(uint64_t periodNs, uint64_t endNs)
+{
+    float inputs[2][BLOCKSIZE];
+    float outputs[2][BLOCKSIZE];
+    float *in[2] = {inputs[0], inputs[1]};
+    float *out[2] = {outputs[0], outputs[1]};
+    uint64_t sample = 0;
+    float sampleRate = DAISY.get_samplerate();
+    uint64_t noteSamples = ((uint64_t)sampleRate * simNoteMs) / 1000;
+
+    uint64_t scheduledNs = SimHardware::Nanos() + periodNs;
+    while (running && scheduledNs < endNs)
+    {
+        // The codec has the block ready before it is due
+        for (size_t i = 0; i < BLOCKSIZE; i++)
+        {
+            float t = (float)(sample % noteSamples) / sampleRate;
+            float note = simInputLevel * expf(-4.0f * t) * sinf(2.0f * (float)PI_VAL * simInputFrequency * t);
+            inputs[0][i] = note;
+            inputs[1][i] = note;
+            sample++;
+        }
+
+        // Spin instead of sleeping, the period is far below the scheduler's resolution
+        while (SimHardware::Nanos() < scheduledNs)
+        {
+        }
+
+        uint64_t startNs = SimHardware::Nanos();
+        {
+            std::lock_guard<std::recursive_mutex> lock(SimHardware::InterruptLock());
+            DaisyDuinoCallback callback = DAISY.GetCallback();
+            if (callback != nullptr)
+            {
+                callback(in, out, BLOCKSIZE);
+            }
+        }
+        uint64_t endBlockNs = SimHardware::Nanos();
+        monitor.RecordCallback(scheduledNs, startNs, endBlockNs);
+
+        for (size_t i = 0; i < BLOCKSIZE; i++)
+        {
+            float value = outputs[AUDIO_OUT_CH][i];
+            if (!isfinite(value))
+            {
+                nonFiniteSamples++;
+            }
+            else if (fabsf(value) > outputPeak)
+            {
+                outputPeak = fabsf(value);
+            }
+        }
+
+        // After an overrun the codec has moved on, resume at its next block instead of catching up
+        scheduledNs += periodNs;
+        if (endBlockNs > scheduledNs)
+        {
+            uint64_t skipped = ((endBlockNs - scheduledNs) / periodNs) + 1;
+            scheduledNs += skipped * periodNs;
+            sample += skipped * BLOCKSIZE;
+            skippedBlocks += skipped;
+        }
+    }
+
+    running = false;
+}
+
+/**
+ * Runs the effect loop back to back, like loop() on the pedal
+ */
+static void LoopThread(uint64_t loopLogNs)
+{
+    while (running)
+    {
+        uint64_t startNs = SimHardware::Nanos();
+        currentEffect->Loop();
+        uint64_t durationNs = SimHardware::Nanos() - startNs;
+
+        loopIterations++;
+        if (durationNs > worstLoopNs)
+        {
+            worstLoopNs = durationNs;
+        }
+        if (durationNs >= loopLogNs)
+        {
+            monitor.Log(EVENT_LOOP, startNs, durationNs, -1, 0);
+        }
+    }
+}
+
+/**
+ * Sets a digital input and logs it, as an interrupt if one fired
+ */
+static void SetDigitalInput(int pin, int value)
+{
+    uint64_t timeNs = SimHardware::Nanos();
+    uint64_t isrNs = SimHardware::SetDigital(pin, value);
+    monitor.Log((isrNs > 0) ? EVENT_ISR : EVENT_SWITCH, timeNs, isrNs, pin, value);
+}
+
+static void RaiseAudioThreadPriority(std::thread &thread)
+{
+#ifdef __linux__
+    sched_param param;
+    param.sched_priority = sched_get_priority_max(SCHED_FIFO);
+    if (pthread_setschedparam(thread.native_handle(), SCHED_FIFO, &param) != 0)
+    {
+        printf("Could not set SCHED_FIFO on the audio thread, running at normal priority\n");
+    }
+#else
+    (void)thread;
+    printf("Real-time priority is only supported on Linux\n");
+#endif
+}
+
+int main(int argc, char **argv)
+{
+    SimOptions options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    // Knobs at noon, switches off
+    const int potPins[] = {effectPotPin1, effectPotPin2, effectPotPin3, effectPotPin4};
+    for (int pin : potPins)
+    {
+        SimHardware::SetAnalog(pin, 512);
+    }
+
+    // Same start up order as setup() in main.cpp
+    DaisyHardware hw = DAISY.init(DAISY_SEED, DAISY_SAMPLE_RATE);
+
+    // The DSP is designed for sampleRateHz, the codec has to run at that rate
+    float sampleRate = DAISY.get_samplerate();
+    if (sampleRate != sampleRateHz)
+    {
+        printf("DAISY_SAMPLE_RATE selects %dHz but the DSP is designed for %dHz\n", (int)sampleRate, (int)sampleRateHz);
+        return 2;
+    }
+
+    dsy_audio_set_blocksize(DSY_AUDIO_INTERNAL, BLOCKSIZE);
+    currentEffect = GetEffectObject(options.effect);
+    currentEffect->Setup(hw.num_channels);
+    DAISY.begin(SimAudioCallback);
+
+    uint64_t periodNs = ((uint64_t)BLOCKSIZE * 1000000000ull) / (uint64_t)sampleRate;
+    monitor.Init(periodNs, (uint64_t)options.windowUs * 1000, options.maxReports);
+
+    printf("Running %s for %.1fs, %d sample blocks at %dHz (%.2fus per block)\n",
+           currentEffect->GetEffectName().c_str(), options.seconds, BLOCKSIZE, (int)sampleRate, (double)periodNs / 1000.0);
+
+    // The audio, loop and control threads each need a core or the host scheduler causes the misses
+    if (std::thread::hardware_concurrency() < 3)
+    {
+        printf("Warning: only %u host cores, misses will mostly reflect the host scheduler\n", std::thread::hardware_concurrency());
+    }
+
+    uint64_t startNs = SimHardware::Nanos();
+    uint64_t endNs = startNs + (uint64_t)(options.seconds * 1e9);
+    std::thread audio(AudioThread, periodNs, endNs);
+    if (options.realtimePriority)
+    {
+        RaiseAudioThreadPriority(audio);
+    }
+    std::thread loop(LoopThread, (uint64_t)options.loopLogUs * 1000);
+
+    // Drive the controls and report misses until the audio thread is done
+    uint64_t nextKnobNs = startNs + (uint64_t)options.knobMs * 1000000;
+    uint64_t nextTapNs = startNs + (uint64_t)options.tapMs * 1000000;
+    uint64_t releaseTapNs = 0;
+    uint64_t nextSwitchNs = startNs + (uint64_t)options.switchMs * 1000000;
+    int switchState = LOW;
+    while (running)
+    {
+        uint64_t nowNs = SimHardware::Nanos();
+
+        if (options.knobMs > 0 && nowNs >= nextKnobNs)
+        {
+            int pin = potPins[random(4)];
+            int value = (int)random(1024);
+            SimHardware::SetAnalog(pin, value);
+            monitor.Log(EVENT_KNOB, nowNs, 0, pin, value);
+            nextKnobNs += (uint64_t)options.knobMs * 1000000;
+        }
+
+        if (options.tapMs > 0 && nowNs >= nextTapNs)
+        {
+            SetDigitalInput(effectSPSTPin4, HIGH);
+            releaseTapNs = nowNs + (uint64_t)simButtonHoldMs * 1000000;
+            nextTapNs += (uint64_t)options.tapMs * 1000000;
+        }
+
+        if (releaseTapNs != 0 && nowNs >= releaseTapNs)
+        {
+            SetDigitalInput(effectSPSTPin4, LOW);
+            releaseTapNs = 0;
+        }
+
+        if (options.switchMs > 0 && nowNs >= nextSwitchNs)
+        {
+            switchState = (switchState == LOW) ? HIGH : LOW;
+            SetDigitalInput(effectSPSTPin3, switchState);
+            nextSwitchNs += (uint64_t)options.switchMs * 1000000;
+        }
+
+        monitor.Service(nowNs);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    audio.join();
+    loop.join();
+
+    // Report the misses still waiting on their window
+    monitor.Service(UINT64_MAX - (uint64_t)options.windowUs * 1000);
+    monitor.PrintSummary();
+    printf("Blocks skipped after overruns: %llu\n", (unsigned long long)skippedBlocks);
+    printf("Loop: %llu iterations, worst %.2fus\n", (unsigned long long)loopIterations, (double)worstLoopNs / 1000.0);
+    printf("Output: peak %.3f, %llu non-finite samples\n", outputPeak, (unsigned long long)nonFiniteSamples);
+
+    currentEffect->Cleanup();
+
+    return (monitor.GetMisses() > 0 || nonFiniteSamples > 0) ? 1 : 0;
+}
+
+#endif
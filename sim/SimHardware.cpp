@@ -0,0 +1,305 @@
+#include "SimHardware.h"
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <stdio.h>
+#include <thread>
+
+// Core clock the DWT cycle counter is scaled to
+static const double simCoreClockHz = 480000000.0;
+
+static const std::chrono::steady_clock::time_point simStart = std::chrono::steady_clock::now();
+
+// Pin state, written by the simulator and the effect from different threads
+static std::atomic<int> analogValues[simPinCount];
+static std::atomic<int> digitalValues[simPinCount];
+static std::atomic<int> outputValues[simPinCount];
+
+// Attached interrupts, only changed from Setup/Cleanup
+struct SimInterrupt
+{
+    callback_function_t callback;
+    uint32_t mode = 0;
+};
+static SimInterrupt interrupts[simPinCount];
+static std::mutex interruptTableLock;
+
+static std::recursive_mutex interruptLock;
+static std::mutex serialLock;
+static std::mt19937 randomEngine(1);
+
+SimSerial Serial;
+SimAudio DAISY;
+SimDwt simDwt;
+SimCoreDebug simCoreDebug;
+
+static bool ValidPin(uint32_t pin)
+{
+    return pin < (uint32_t)simPinCount;
+}
+
+uint64_t SimHardware::Nanos()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - simStart).count();
+}
+
+void SimHardware::SetAnalog(int pin, int value)
+{
+    if (ValidPin(pin))
+    {
+        analogValues[pin] = value;
+    }
+}
+
+uint64_t SimHardware::SetDigital(int pin, int value)
+{
+    if (!ValidPin(pin))
+    {
+        return 0;
+    }
+
+    int previous = digitalValues[pin].exchange(value);
+
+    callback_function_t callback;
+    uint32_t mode;
+    {
+        std::lock_guard<std::mutex> lock(interruptTableLock);
+        callback = interrupts[pin].callback;
+        mode = interrupts[pin].mode;
+    }
+
+    bool rising = (previous == LOW && value == HIGH);
+    bool falling = (previous == HIGH && value == LOW);
+    bool fire = callback && ((mode == RISING && rising) || (mode == FALLING && falling) || (mode == CHANGE && (rising || falling)));
+    if (!fire)
+    {
+        return 0;
+    }
+
+    // Interrupts do not nest with the audio interrupt on the single core, so take the same lock
+    uint64_t start = Nanos();
+    {
+        std::lock_guard<std::recursive_mutex> lock(interruptLock);
+        callback();
+    }
+    return Nanos() - start;
+}
+
+int SimHardware::GetOutput(int pin)
+{
+    return ValidPin(pin) ? outputValues[pin].load() : 0;
+}
+
+std::recursive_mutex &SimHardware::InterruptLock()
+{
+    return interruptLock;
+}
+
+// Arduino core
+
+unsigned long millis()
+{
+    return (unsigned long)(SimHardware::Nanos() / 1000000);
+}
+
+unsigned long micros()
+{
+    return (unsigned long)(SimHardware::Nanos() / 1000);
+}
+
+void delay(unsigned long ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void pinMode(uint32_t pin, uint32_t mode)
+{
+    (void)pin;
+    (void)mode;
+}
+
+int digitalRead(uint32_t pin)
+{
+    return ValidPin(pin) ? digitalValues[pin].load() : LOW;
+}
+
+void digitalWrite(uint32_t pin, uint32_t value)
+{
+    if (ValidPin(pin))
+    {
+        outputValues[pin] = (int)value;
+    }
+}
+
+int analogRead(uint32_t pin)
+{
+    return ValidPin(pin) ? analogValues[pin].load() : 0;
+}
+
+void analogWrite(uint32_t pin, int value)
+{
+    if (ValidPin(pin))
+    {
+        outputValues[pin] = value;
+    }
+}
+
+void attachInterrupt(uint32_t pin, callback_function_t callback, uint32_t mode)
+{
+    if (ValidPin(pin))
+    {
+        std::lock_guard<std::mutex> lock(interruptTableLock);
+        interrupts[pin].callback = callback;
+        interrupts[pin].mode = mode;
+    }
+}
+
+void detachInterrupt(uint32_t pin)
+{
+    if (ValidPin(pin))
+    {
+        std::lock_guard<std::mutex> lock(interruptTableLock);
+        interrupts[pin].callback = nullptr;
+    }
+}
+
+long random(long max)
+{
+    return random(0, max);
+}
+
+long random(long min, long max)
+{
+    if (max <= min)
+    {
+        return min;
+    }
+    return min + (long)(randomEngine() % (unsigned long)(max - min));
+}
+
+void randomSeed(unsigned long seed)
+{
+    randomEngine.seed((std::mt19937::result_type)seed);
+}
+
+// Serial
+
+void SimSerial::begin(unsigned long baud)
+{
+    (void)baud;
+}
+
+void SimSerial::print(const char *text)
+{
+    std::lock_guard<std::mutex> lock(serialLock);
+    fputs(text, stdout);
+}
+
+void SimSerial::print(const String &text)
+{
+    print(text.c_str());
+}
+
+void SimSerial::print(int value)
+{
+    print(String(value));
+}
+
+void SimSerial::print(unsigned int value)
+{
+    print(String(value));
+}
+
+void SimSerial::print(long value)
+{
+    print(String(value));
+}
+
+void SimSerial::print(unsigned long value)
+{
+    print(String(value));
+}
+
+void SimSerial::print(double value, int decimalPlaces)
+{
+    char text[64];
+    snprintf(text, sizeof(text), "%.*f", decimalPlaces, value);
+    print(text);
+}
+
+void SimSerial::println()
+{
+    print("\r\n");
+}
+
+// DaisyDuino
+
+DaisyHardware SimAudio::init(DaisyDuinoDevice device, DaisyDuinoSampleRate sampleRate)
+{
+    (void)device;
+
+    // Rates in DaisyDuinoSampleRate order
+    static const float rates[AUDIO_SR_LAST] = {8000.0f, 16000.0f, 32000.0f, 48000.0f, 96000.0f};
+    if (sampleRate < AUDIO_SR_LAST)
+    {
+        sampleRateHz = rates[sampleRate];
+    }
+
+    DaisyHardware hw;
+    hw.num_channels = 2;
+    return hw;
+}
+
+void SimAudio::begin(DaisyDuinoCallback pCallback)
+{
+    callback = pCallback;
+}
+
+void SimAudio::end()
+{
+    callback = nullptr;
+}
+
+float SimAudio::get_samplerate()
+{
+    return sampleRateHz;
+}
+
+DaisyDuinoCallback SimAudio::GetCallback()
+{
+    return callback;
+}
+
+void dsy_audio_set_blocksize(uint8_t device, size_t blockSize)
+{
+    (void)device;
+    (void)blockSize;
+}
+
+void __disable_irq()
+{
+    interruptLock.lock();
+}
+
+void __enable_irq()
+{
+    interruptLock.unlock();
+}
+
+SimCycleCount::operator uint32_t() const
+{
+    // Wraps like the hardware counter
+    return (uint32_t)(uint64_t)((double)SimHardware::Nanos() * (simCoreClockHz / 1e9)) - offset;
+}
+
+SimCycleCount &SimCycleCount::operator=(uint32_t value)
+{
+    offset = 0;
+    offset = (uint32_t)(*this) - value;
+    return *this;
+}
@@ -0,0 +1,40 @@
+#ifndef SIM_HARDWARE_H
+#define SIM_HARDWARE_H
+
+#include <mutex>
+#include "DaisyDuino.h"
+
+/**
+ * Simulator side of the Arduino/DaisyDuino shims
+ */
+namespace SimHardware
+{
+    /**
+     * Nanoseconds since the simulation started, the time base for millis(), micros() and the event log
+     */
+    uint64_t Nanos();
+
+    /**
+     * Sets the value analogRead() returns for a pin (0 - 1023)
+     */
+    void SetAnalog(int pin, int value);
+
+    /**
+     * Sets the value digitalRead() returns for a pin
+     * Fires the attached interrupt on the calling thread, under the interrupt lock, if the edge matches
+     * @return Nanoseconds spent in the interrupt handler, 0 if none ran
+     */
+    uint64_t SetDigital(int pin, int value);
+
+    /**
+     * @return Last value written with analogWrite() or digitalWrite()
+     */
+    int GetOutput(int pin);
+
+    /**
+     * Lock shared by __disable_irq() and everything that models an interrupt (audio, buttons)
+     */
+    std::recursive_mutex &InterruptLock();
+}
+
+#endif
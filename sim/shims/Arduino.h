@@ -0,0 +1,124 @@
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+/**********************************************
+ * Host shim for the parts of the Arduino core used by the pedal
+ *
+ * Pins are backed by arrays the simulator drives, time comes from the host steady clock,
+ * and attached interrupts are fired by the simulator when it changes a digital pin.
+ **********************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <functional>
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define LOW 0x0
+#define HIGH 0x1
+
+#define CHANGE 0x2
+#define FALLING 0x3
+#define RISING 0x4
+
+#define LED_BUILTIN 99
+
+// Highest pin number the simulator tracks
+static const int simPinCount = 100;
+
+typedef std::function<void(void)> callback_function_t;
+
+/**
+ * Minimal Arduino String, enough for the debug output and effect names
+ */
+class String : public std::string
+{
+public:
+    String(const char *text = "") : std::string(text) {}
+    String(const std::string &text) : std::string(text) {}
+    String(int value) : std::string(std::to_string(value)) {}
+    String(unsigned int value) : std::string(std::to_string(value)) {}
+    String(long value) : std::string(std::to_string(value)) {}
+    String(unsigned long value) : std::string(std::to_string(value)) {}
+    String(float value) : std::string(std::to_string(value)) {}
+};
+
+inline String operator+(const String &a, const String &b)
+{
+    return String(static_cast<const std::string &>(a) + static_cast<const std::string &>(b));
+}
+
+inline String operator+(const char *a, const String &b)
+{
+    return String(std::string(a) + static_cast<const std::string &>(b));
+}
+
+inline String operator+(const String &a, const char *b)
+{
+    return String(static_cast<const std::string &>(a) + b);
+}
+
+/**
+ * Serial port, printed to stdout
+ */
+class SimSerial
+{
+public:
+    void begin(unsigned long baud);
+    void print(const char *text);
+    void print(const String &text);
+    void print(int value);
+    void print(unsigned int value);
+    void print(long value);
+    void print(unsigned long value);
+    void print(double value, int decimalPlaces = 2);
+    void println();
+
+    template <typename T>
+    void println(const T &value)
+    {
+        print(value);
+        println();
+    }
+
+    void println(double value, int decimalPlaces)
+    {
+        print(value, decimalPlaces);
+        println();
+    }
+};
+
+extern SimSerial Serial;
+
+// Time
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// Pins
+void pinMode(uint32_t pin, uint32_t mode);
+int digitalRead(uint32_t pin);
+void digitalWrite(uint32_t pin, uint32_t value);
+int analogRead(uint32_t pin);
+void analogWrite(uint32_t pin, int value);
+
+// Interrupts
+void attachInterrupt(uint32_t pin, callback_function_t callback, uint32_t mode);
+void detachInterrupt(uint32_t pin);
+inline uint32_t digitalPinToInterrupt(uint32_t pin)
+{
+    return pin;
+}
+
+// Random numbers
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+#endif
@@ -0,0 +1,177 @@
+#ifndef SIM_DAISY_DUINO_H
+#define SIM_DAISY_DUINO_H
+
+/**********************************************
+ * Host shim for the parts of DaisyDuino used by the pedal
+ *
+ * DAISY.begin() only stores the callback, the simulator drives it from its real-time thread.
+ * __disable_irq() takes the same lock the simulated audio and button interrupts run under,
+ * so code that masks interrupts on the hardware is also exclusive with them here.
+ **********************************************/
+
+#include "Arduino.h"
+
+// Large buffers have no special placement on the host
+#define DSY_SDRAM_BSS
+
+typedef void (*DaisyDuinoCallback)(float **in, float **out, size_t size);
+
+enum DaisyDuinoDevice
+{
+    DAISY_SEED,
+    DAISY_POD,
+    DAISY_PETAL,
+    DAISY_FIELD,
+    DAISY_PATCH
+};
+
+// Same as DaisyDuino, the values select a rate, DAISY.get_samplerate() returns it in Hz
+enum DaisyDuinoSampleRate
+{
+    AUDIO_SR_8K,
+    AUDIO_SR_16K,
+    AUDIO_SR_32K,
+    AUDIO_SR_48K,
+    AUDIO_SR_96K,
+    AUDIO_SR_LAST
+};
+
+enum DaisyAudioDevice
+{
+    DSY_AUDIO_INTERNAL,
+    DSY_AUDIO_EXTERNAL
+};
+
+struct DaisyHardware
+{
+    size_t num_channels;
+};
+
+class SimAudio
+{
+public:
+    DaisyHardware init(DaisyDuinoDevice device, DaisyDuinoSampleRate sampleRate);
+    void begin(DaisyDuinoCallback callback);
+    void end();
+    float get_samplerate();
+    DaisyDuinoCallback GetCallback();
+
+private:
+    DaisyDuinoCallback callback = nullptr;
+    float sampleRateHz = 48000.0f;
+};
+
+extern SimAudio DAISY;
+
+void dsy_audio_set_blocksize(uint8_t device, size_t blockSize);
+
+// Cortex-M intrinsics
+void __disable_irq();
+void __enable_irq();
+inline void __DSB() {}
+inline void __ISB() {}
+inline void __DMB() {}
+
+/**
+ * DWT cycle counter, reads the host clock scaled to the 480MHz core clock
+ */
+class SimCycleCount
+{
+public:
+    operator uint32_t() const;
+    SimCycleCount &operator=(uint32_t value);
+
+private:
+    uint32_t offset = 0;
+};
+
+struct SimDwt
+{
+    SimCycleCount CYCCNT;
+    uint32_t CTRL;
+    uint32_t LAR;
+};
+
+struct SimCoreDebug
+{
+    uint32_t DEMCR;
+};
+
+extern SimDwt simDwt;
+extern SimCoreDebug simCoreDebug;
+
+#define DWT (&simDwt)
+#define CoreDebug (&simCoreDebug)
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk (1UL)
+
+namespace daisysp
+{
+    /**
+     * Same behavior as daisysp::DelayLine
+     */
+    template <typename T, size_t max_size>
+    class DelayLine
+    {
+    public:
+        void Init()
+        {
+            Reset();
+        }
+
+        void Reset()
+        {
+            for (size_t i = 0; i < max_size; i++)
+            {
+                line_[i] = T(0);
+            }
+            write_ptr_ = 0;
+            delay_ = 1;
+        }
+
+        inline void SetDelay(size_t delay)
+        {
+            frac_ = 0.0f;
+            delay_ = delay < max_size ? delay : max_size - 1;
+        }
+
+        inline void SetDelay(float delay)
+        {
+            int32_t int_delay = static_cast<int32_t>(delay);
+            frac_ = delay - static_cast<float>(int_delay);
+            delay_ = static_cast<size_t>(int_delay) < max_size ? int_delay : max_size - 1;
+        }
+
+        inline void Write(const T sample)
+        {
+            line_[write_ptr_] = sample;
+            write_ptr_ = (write_ptr_ - 1 + max_size) % max_size;
+        }
+
+        inline const T Read() const
+        {
+            T a = line_[(write_ptr_ + delay_) % max_size];
+            T b = line_[(write_ptr_ + delay_ + 1) % max_size];
+            return a + (b - a) * frac_;
+        }
+
+        inline const T Read(float delay) const
+        {
+            int32_t delay_integral = static_cast<int32_t>(delay);
+            float delay_fractional = delay - static_cast<float>(delay_integral);
+            const T a = line_[(write_ptr_ + delay_integral) % max_size];
+            const T b = line_[(write_ptr_ + delay_integral + 1) % max_size];
+            return a + (b - a) * delay_fractional;
+        }
+
+    private:
+        float frac_;
+        size_t write_ptr_;
+        size_t delay_;
+        T line_[max_size];
+    };
+}
+
+using namespace daisysp;
+
+#endif
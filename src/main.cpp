@@ -2,6 +2,16 @@
 #include "DaisyDuino.h"
 #include "EffectType.h"
 #include "PedalConfig.h"
+#include "../lib/Utility/CycleCounter.h"
+#include "../lib/Utility/MemoryPlacement.h"
+#include "../lib/Filters/FilterBenchmark.h"
+#include "../lib/Saturation/SaturationBenchmark.h"
+#include "../lib/Convolution/ConvolutionBenchmark.h"
+#include "../lib/Reverb/ReverbBenchmark.h"
+#include "../lib/SingleEcho/DelayBenchmark.h"
+#include "../lib/SingleEcho/GrainBenchmark.h"
+#include "../lib/Dynamics/DynamicsBenchmark.h"
+#include "../lib/Analysis/PitchBenchmark.h"
 #include "utility/hid_audio.h"
 
 // Global variables
@@ -13,6 +23,39 @@ volatile EffectType currentEffectType = SINGLEECHO;
 volatile EffectType selectedEffectType = SINGLEECHO;
 IEffect *currentEffect;
 
+// Boot timing, micros() counts from the HAL init at reset
+unsigned long setupStartMicros = 0;
+unsigned long audioStartMicros = 0;
+volatile unsigned long firstSampleMicros = 0;
+bool bootTimeReported = false;
+
+/**
+ * Forwards the audio to the current effect and timestamps the first callback
+ */
+ITCM_FUNC void AudioCallback(float **in, float **out, size_t size)
+{
+    if (firstSampleMicros == 0)
+    {
+        firstSampleMicros = micros();
+    }
+
+    currentEffect->AudioCallback(in, out, size);
+}
+
+/**
+ * Prints the boot to first sample time once audio is running
+ */
+void ReportBootTime()
+{
+    debugPrint("Boot to first sample: ");
+    debugPrint(firstSampleMicros);
+    debugPrint("us (setup started at ");
+    debugPrint(setupStartMicros);
+    debugPrint("us, audio started at ");
+    debugPrint(audioStartMicros);
+    debugPrintln("us)");
+}
+
 /**
  * Sets the selected effect type based on reading the selector
  */
@@ -40,9 +83,12 @@ bool ReadSelectedEffect()
 
 void setup()
 {
+    setupStartMicros = micros();
+
     // Initialize the serial debug output
     initDebugPrint();
     debugPrintln("Starting DaisyPedal...");
+    ReportMemoryPlacement();
 
     // Initialize Daisy
     hw = DAISY.init(DAISY_SEED, DAISY_SAMPLE_RATE);
@@ -51,6 +97,22 @@ void setup()
     // Update the block size to minimize noise
     dsy_audio_set_blocksize(DSY_AUDIO_INTERNAL, BLOCKSIZE);
 
+    // Enable the cycle counter used for CPU measurements
+    CycleCounter::Enable();
+
+    // Run the DSP library benchmarks before any audio starts
+    if (BENCHMARK)
+    {
+        RunFilterBenchmark();
+        RunSaturationBenchmark();
+        RunConvolutionBenchmark();
+        RunReverbBenchmark();
+        RunDelayBenchmark();
+        RunGrainBenchmark();
+        RunDynamicsBenchmark();
+        RunPitchBenchmark();
+    }
+
 #ifndef BYPASS_SELECTOR
     // Initialize the encoder pins
     pinMode(effectSelectorPin1, INPUT);
@@ -68,7 +130,8 @@ void setup()
     // Start the effect
     debugPrintln("Starting: " + currentEffect->GetEffectName());
     currentEffect->Setup(num_channels);
-    DAISY.begin((DaisyDuinoCallback)[](float **in, float **out, size_t size) { return currentEffect->AudioCallback(in, out, size); });
+    audioStartMicros = micros();
+    DAISY.begin(AudioCallback);
 
     // Initialize and turn on the control LED
     pinMode(controlLedPin, OUTPUT);
@@ -77,6 +140,13 @@ void setup()
 
 void loop()
 {
+    // Report the boot time once the first sample has been processed
+    if (!bootTimeReported && firstSampleMicros != 0)
+    {
+        ReportBootTime();
+        bootTimeReported = true;
+    }
+
 #ifndef BYPASS_SELECTOR
     // Check if we have a new effect type and switch to the new state
     if (ReadSelectedEffect())
@@ -90,7 +160,7 @@ void loop()
         // Start the new effect
         debugPrintln("Switching to: " + currentEffect->GetEffectName());
         currentEffect->Setup(num_channels);
-        DAISY.begin((DaisyDuinoCallback)[](float **in, float **out, size_t size) { return currentEffect->AudioCallback(in, out, size); });
+        DAISY.begin(AudioCallback);
     }
 #endif
 
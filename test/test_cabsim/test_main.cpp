@@ -0,0 +1,229 @@
+/**********************************************
+ * PartitionedConvolver and CabSim host tests, run with: pio test -e native
+ *
+ * The cost test is the host run of the convolution benchmark: it times the partitioned
+ * convolver one sample at a time against a direct form FIR of the same length. Host
+ * numbers only compare the two methods, the device figures come from RunConvolutionBenchmark().
+ *
+ * The load test runs the CabSim audio callback on its own thread under the interrupt lock,
+ * like the simulator does, while the main thread swaps the impulse response.
+ **********************************************/
+
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "../../lib/Convolution/PartitionedConvolver.h"
+#include "../../lib/CabSim/CabSim.h"
+#include "../../lib/Utility/CycleCounter.h"
+#include "../../sim/SimHardware.h"
+
+// Same shape as the CabSim convolver
+static const size_t testPartitionSize = cabPartitionSize;
+static const size_t testMaxPartitions = cabMaxPartitions;
+static const size_t testIrLength = testPartitionSize * testMaxPartitions;
+static const size_t testSamples = 8 * testIrLength;
+
+// Largest difference from direct convolution, the FFT runs in single precision
+static const float testMaxError = 1e-4f;
+
+// Test tone for the load test, its largest step between samples sets the click threshold
+static const float testToneFreq = 220.0f;
+static const float testToneLevel = 0.5f;
+static const float testMaxStep = 4.0f * testToneLevel * 2.0f * (float)PI_VAL * testToneFreq / sampleRateHz;
+
+// Samples played before and after the load
+static const size_t testLoadPreroll = 9600;
+static const size_t testLoadSamples = 96000;
+
+// The loaded impulse response inverts and delays the input, which clicks if switched in without a fade
+static const size_t testLoadIrDelay = 100;
+
+static PartitionedConvolver<testPartitionSize, testMaxPartitions> testConvolver;
+static float testIr[testIrLength];
+static float testInput[testSamples];
+static float testHistory[testIrLength * 2];
+static float testOutput[testLoadSamples];
+static CabSim testCabSim;
+
+// Noise in -1 to 1 from a fixed seed, so every run sees the same signal
+static float NextNoise(uint32_t &state)
+{
+    state = (state * 1664525u) + 1013904223u;
+    return ((float)(state >> 8) * (2.0f / 16777216.0f)) - 1.0f;
+}
+
+static float Tone(size_t n)
+{
+    return testToneLevel * sinf(2.0f * (float)PI_VAL * testToneFreq * (float)n / sampleRateHz);
+}
+
+// Decaying noise impulse response, like the benchmark uses
+static void MakeIr(uint32_t seed)
+{
+    for (size_t i = 0; i < testIrLength; i++)
+    {
+        testIr[i] = NextNoise(seed) * expf(-(float)i / 800.0f);
+    }
+}
+
+void setUp()
+{
+    uint32_t seed = 7;
+    for (size_t i = 0; i < testSamples; i++)
+    {
+        testInput[i] = NextNoise(seed);
+    }
+    MakeIr(1);
+}
+
+void tearDown()
+{
+}
+
+void test_convolver_matches_direct_convolution()
+{
+    testConvolver.Init();
+    testConvolver.LoadImpulseResponse(testIr, testIrLength);
+    size_t latency = testConvolver.GetLatency();
+
+    float maxError = 0.0f;
+    for (size_t n = 0; n < testSamples; n++)
+    {
+        float out = testConvolver.Process(testInput[n]);
+        if (n < latency)
+        {
+            continue;
+        }
+
+        // Direct convolution of the input, delayed by the latency
+        size_t m = n - latency;
+        double expected = 0.0;
+        for (size_t k = 0; k < testIrLength && k <= m; k++)
+        {
+            expected += (double)testIr[k] * (double)testInput[m - k];
+        }
+        maxError = fmaxf(maxError, fabsf(out - (float)expected));
+    }
+
+    TEST_ASSERT_TRUE(maxError < testMaxError);
+    TEST_ASSERT_EQUAL_UINT32(0, testConvolver.GetOverruns());
+}
+
+void test_convolver_costs_less_than_direct_fir()
+{
+    CycleCounter::Enable();
+    CycleCounter partitionedCycles;
+    CycleCounter directCycles;
+    volatile float sink = 0.0f;
+
+    testConvolver.Init();
+    testConvolver.LoadImpulseResponse(testIr, testIrLength);
+    for (size_t n = 0; n < testSamples; n++)
+    {
+        partitionedCycles.Start();
+        sink = testConvolver.Process(testInput[n]);
+        partitionedCycles.Stop(1);
+    }
+
+    // Direct form FIR with a doubled history so the taps never wrap, as in RunConvolutionBenchmark()
+    for (size_t i = 0; i < testIrLength * 2; i++)
+    {
+        testHistory[i] = 0.0f;
+    }
+    size_t writeIndex = 0;
+    for (size_t n = 0; n < testSamples; n++)
+    {
+        directCycles.Start();
+        writeIndex = (writeIndex == 0) ? (testIrLength - 1) : (writeIndex - 1);
+        testHistory[writeIndex] = testInput[n];
+        testHistory[writeIndex + testIrLength] = testInput[n];
+        float acc = 0.0f;
+        for (size_t k = 0; k < testIrLength; k++)
+        {
+            acc += testIr[k] * testHistory[writeIndex + k];
+        }
+        sink = acc;
+        directCycles.Stop(1);
+    }
+    (void)sink;
+
+    printf("%u taps at 480MHz equivalent: partitioned %.1f cycles/sample (worst %lu), direct FIR %.1f cycles/sample\n",
+           (unsigned)testIrLength, partitionedCycles.CyclesPerSample(), (unsigned long)partitionedCycles.MaxCycles(),
+           directCycles.CyclesPerSample());
+
+    TEST_ASSERT_TRUE(partitionedCycles.CyclesPerSample() < directCycles.CyclesPerSample());
+    TEST_ASSERT_EQUAL_UINT32(0, testConvolver.GetOverruns());
+}
+
+void test_ir_load_crossfades_without_a_click()
+{
+    SimHardware::SetAnalog(cabLevelKnobPin, 0);
+    SimHardware::SetAnalog(cabMixKnobPin, 0);
+    testCabSim.Setup(2);
+
+    // Audio callback thread, one sample at a time under the interrupt lock, paced at about the real rate
+    std::atomic<size_t> played(0);
+    std::thread audio([&played]() {
+        float inputs[2][1] = {{0.0f}, {0.0f}};
+        float outputs[2][1] = {{0.0f}, {0.0f}};
+        float *in[2] = {inputs[0], inputs[1]};
+        float *out[2] = {outputs[0], outputs[1]};
+
+        for (size_t n = 0; n < testLoadSamples; n++)
+        {
+            in[AUDIO_IN_CH][0] = Tone(n);
+            {
+                std::lock_guard<std::recursive_mutex> lock(SimHardware::InterruptLock());
+                testCabSim.AudioCallback(in, out, 1);
+            }
+            testOutput[n] = out[AUDIO_OUT_CH][0];
+            played++;
+
+            if (n % 96 == 0)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    });
+
+    // Load a new impulse response while the cabinet is playing
+    while (played < testLoadPreroll)
+    {
+    }
+    for (size_t i = 0; i < testIrLength; i++)
+    {
+        testIr[i] = (i == testLoadIrDelay) ? -1.0f : 0.0f;
+    }
+    testCabSim.LoadImpulseResponse(testIr, testIrLength);
+    size_t loadedAt = played;
+    audio.join();
+    testCabSim.Cleanup();
+
+    // The output never steps further than the tone itself can, and the new impulse response plays afterwards
+    size_t delay = testLoadIrDelay + testConvolver.GetLatency();
+    float maxStep = 0.0f;
+    float maxTailError = 0.0f;
+    for (size_t n = 1; n < testLoadSamples; n++)
+    {
+        maxStep = fmaxf(maxStep, fabsf(testOutput[n] - testOutput[n - 1]));
+        if (n > testLoadSamples / 2)
+        {
+            maxTailError = fmaxf(maxTailError, fabsf(testOutput[n] + Tone(n - delay)));
+        }
+    }
+    TEST_ASSERT_TRUE(loadedAt < testLoadSamples / 2);
+    TEST_ASSERT_TRUE(maxStep < testMaxStep);
+    TEST_ASSERT_TRUE(maxTailError < testMaxError * 10.0f);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_convolver_matches_direct_convolution);
+    RUN_TEST(test_convolver_costs_less_than_direct_fir);
+    RUN_TEST(test_ir_load_crossfades_without_a_click);
+    return UNITY_END();
+}
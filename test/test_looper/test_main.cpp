@@ -0,0 +1,286 @@
+/**********************************************
+ * LoopRecorder host tests, run with: pio test -e native
+ *
+ * The audio callback and Loop() are interleaved on one thread, Service() runs every
+ * testServiceInterval samples, which is far less often than Loop() runs on the pedal.
+ * Taps take effect on the next processed sample, like a switch interrupt between callbacks.
+ * The starved tests hold Service() off for several cache lengths, like a Loop() stuck behind
+ * a slow task, and check that the missed samples are silent rather than stale.
+ **********************************************/
+
+#include <unity.h>
+#include "../../lib/TapLooper/LoopRecorder.h"
+#include "../../lib/Utility/CycleCounter.h"
+
+// Samples between Service() calls
+static const size_t testServiceInterval = 64;
+
+// Loop lengths, one inside the head, one ending part way through a chunk and one several times the cache
+static const size_t testShortLoop = 1000;
+static const size_t testLongLoop = looperHeadSize + (3 * looperChunkSize) + 100;
+static const size_t testCacheLoop = looperHeadSize + (5 * looperCacheChunks * looperChunkSize) + 100;
+
+// Loop position Service() stops running at, and for how long, in the starved tests
+static const size_t testStarveStart = looperHeadSize + (2 * looperChunkSize) + 200;
+static const size_t testStarveSamples = 3 * looperCacheChunks * looperChunkSize;
+
+// Level left in the storage by an older loop
+static const LoopSample testLeftover = 12345;
+
+// Samples played before the first tap, and the input offset of the overdubbed part
+static const size_t testPreroll = 37;
+static const size_t testOverdubOffset = 12345;
+
+// Error allowed by the 16 bit storage, per recorded layer
+static const float testSampleTolerance = 2.0f / 32767.0f;
+
+// Callback budget at 480MHz and the average share of it the looper may use
+static const float testCyclesPerSampleBudget = 480000000.0f / sampleRateHz;
+static const float testAverageCostShare = 0.1f;
+
+static LoopSample testStorage[looperStorageSize];
+static LoopBuffers testBuffers;
+static LoopRecorder recorder;
+static size_t sampleCount;
+static bool serviceStarved;
+
+// Loop positions the audio callback had no cached chunk for
+static bool testMissed[testCacheLoop];
+
+// Deterministic input, kept within +-0.4 so an overdub does not clip
+static float Input(size_t n)
+{
+    return ((float)((n * 7919) % 1001) - 500.0f) * (0.4f / 500.0f);
+}
+
+// Runs Loop() when it is due
+static void ServiceIfDue()
+{
+    sampleCount++;
+    if (!serviceStarved && sampleCount % testServiceInterval == 0)
+    {
+        recorder.Service();
+    }
+}
+
+// Runs one sample of the audio callback, then Loop() when it is due
+static float Step(float in)
+{
+    float out = recorder.Process(in);
+    ServiceIfDue();
+    return out;
+}
+
+// Runs one sample with Service() held off from the given position on, and marks the position if it underran
+static float StarvedStep(float in, size_t position)
+{
+    serviceStarved = (position >= testStarveStart) && (position < testStarveStart + testStarveSamples);
+
+    size_t underruns = recorder.GetUnderruns();
+    float out = Step(in);
+    testMissed[position] = (recorder.GetUnderruns() != underruns);
+
+    serviceStarved = false;
+    return out;
+}
+
+// Records length samples after a preroll and closes the loop on the next sample, returns the input index it starts at
+static size_t RecordLoop(size_t length)
+{
+    for (size_t i = 0; i < testPreroll; i++)
+    {
+        Step(0.0f);
+    }
+
+    size_t start = sampleCount;
+    recorder.Tap();
+    for (size_t i = 0; i < length; i++)
+    {
+        Step(Input(start + i));
+    }
+    recorder.Tap();
+
+    return start;
+}
+
+// Plays passes of the loop and checks every sample against the expected content, missed positions hold only the recording
+static void CheckPlayback(size_t start, size_t length, size_t passes, bool overdubbed, bool missedOverdub = false)
+{
+    for (size_t i = 0; i < length * passes; i++)
+    {
+        size_t position = i % length;
+        float expected = Input(start + position);
+        if (overdubbed && !(missedOverdub && testMissed[position]))
+        {
+            expected += Input(testOverdubOffset + position);
+        }
+
+        float out = Step(0.0f);
+        TEST_ASSERT_FLOAT_WITHIN(testSampleTolerance * (overdubbed ? 2.0f : 1.0f), expected, out);
+    }
+}
+
+void setUp()
+{
+    recorder.Init(testStorage, &testBuffers);
+    sampleCount = 0;
+    serviceStarved = false;
+    for (size_t i = 0; i < testCacheLoop; i++)
+    {
+        testMissed[i] = false;
+    }
+}
+
+void tearDown()
+{
+}
+
+void test_storage_holds_max_length()
+{
+    TEST_ASSERT_TRUE(looperHeadSize + looperStorageSize <= (size_t)sampleRateHz * looperMaxSeconds);
+    TEST_ASSERT_TRUE(looperHeadSize + looperStorageSize + looperChunkSize > (size_t)sampleRateHz * looperMaxSeconds);
+}
+
+void test_loop_points_inside_head()
+{
+    size_t start = RecordLoop(testShortLoop);
+    CheckPlayback(start, testShortLoop, 3, false);
+
+    TEST_ASSERT_EQUAL(LOOP_PLAYING, recorder.GetState());
+    TEST_ASSERT_EQUAL_UINT32(testShortLoop, recorder.GetLoopLength());
+    TEST_ASSERT_EQUAL_UINT32(0, recorder.GetUnderruns());
+}
+
+void test_loop_points_across_chunks()
+{
+    size_t start = RecordLoop(testLongLoop);
+    CheckPlayback(start, testLongLoop, 3, false);
+
+    TEST_ASSERT_EQUAL(LOOP_PLAYING, recorder.GetState());
+    TEST_ASSERT_EQUAL_UINT32(testLongLoop, recorder.GetLoopLength());
+    TEST_ASSERT_EQUAL_UINT32(0, recorder.GetUnderruns());
+}
+
+void test_loop_points_across_the_cache()
+{
+    size_t start = RecordLoop(testCacheLoop);
+    CheckPlayback(start, testCacheLoop, 3, false);
+
+    TEST_ASSERT_EQUAL(LOOP_PLAYING, recorder.GetState());
+    TEST_ASSERT_EQUAL_UINT32(testCacheLoop, recorder.GetLoopLength());
+    TEST_ASSERT_EQUAL_UINT32(0, recorder.GetUnderruns());
+}
+
+void test_overdub_cost_and_content()
+{
+    CycleCounter::Enable();
+
+    size_t start = RecordLoop(testCacheLoop);
+    CheckPlayback(start, testCacheLoop, 1, false);
+
+    // Overdub one full pass, timing every callback on its own and on average
+    CycleCounter overdubCycles;
+    size_t overBudget = 0;
+    recorder.Tap();
+    for (size_t i = 0; i < testCacheLoop; i++)
+    {
+        CycleCounter sampleCycles;
+        overdubCycles.Start();
+        sampleCycles.Start();
+        recorder.Process(Input(testOverdubOffset + i));
+        sampleCycles.Stop(1);
+        overdubCycles.Stop(1);
+        ServiceIfDue();
+
+        if ((float)sampleCycles.MaxCycles() > testCyclesPerSampleBudget)
+        {
+            overBudget++;
+        }
+    }
+    TEST_ASSERT_EQUAL(LOOP_OVERDUBBING, recorder.GetState());
+    recorder.Tap();
+
+    // The SDRAM traffic all happens in Service(), so only host scheduling noise may push a callback over
+    TEST_ASSERT_TRUE(overdubCycles.CyclesPerSample() < testCyclesPerSampleBudget * testAverageCostShare);
+    TEST_ASSERT_TRUE(overBudget <= testCacheLoop / 1000);
+    TEST_ASSERT_EQUAL_UINT32(0, recorder.GetUnderruns());
+
+    // Both parts play back together
+    CheckPlayback(start, testCacheLoop, 2, true);
+    TEST_ASSERT_EQUAL(LOOP_PLAYING, recorder.GetState());
+    TEST_ASSERT_EQUAL_UINT32(0, recorder.GetUnderruns());
+}
+
+void test_starved_recording_is_silent()
+{
+    // An older loop is still in the storage, none of it may play back
+    for (size_t i = 0; i < testCacheLoop; i++)
+    {
+        testStorage[i] = testLeftover;
+    }
+
+    for (size_t i = 0; i < testPreroll; i++)
+    {
+        Step(0.0f);
+    }
+    size_t start = sampleCount;
+    recorder.Tap();
+    for (size_t i = 0; i < testCacheLoop; i++)
+    {
+        StarvedStep(Input(start + i), i);
+    }
+    recorder.Tap();
+
+    // Whole chunks went by without a cached one, and the chunk Service() resumed in was cached part way through
+    size_t resume = testStarveStart + testStarveSamples;
+    size_t underruns = recorder.GetUnderruns();
+    TEST_ASSERT_TRUE(underruns > looperCacheChunks * looperChunkSize);
+    TEST_ASSERT_TRUE(testMissed[resume - 1]);
+    TEST_ASSERT_FALSE(testMissed[resume + testServiceInterval]);
+    TEST_ASSERT_TRUE((resume - looperHeadSize) % looperChunkSize != 0);
+
+    // Missed samples play as silence, everything else as recorded
+    for (size_t i = 0; i < testCacheLoop * 2; i++)
+    {
+        size_t position = i % testCacheLoop;
+        float expected = testMissed[position] ? 0.0f : Input(start + position);
+        TEST_ASSERT_FLOAT_WITHIN(testSampleTolerance, expected, Step(0.0f));
+    }
+    TEST_ASSERT_EQUAL_UINT32(underruns, recorder.GetUnderruns());
+}
+
+void test_starved_overdub_keeps_the_recording()
+{
+    size_t start = RecordLoop(testCacheLoop);
+    CheckPlayback(start, testCacheLoop, 1, false);
+
+    // Missed samples play as silence while overdubbing
+    recorder.Tap();
+    for (size_t i = 0; i < testCacheLoop; i++)
+    {
+        float out = StarvedStep(Input(testOverdubOffset + i), i);
+        TEST_ASSERT_FLOAT_WITHIN(testSampleTolerance, testMissed[i] ? 0.0f : Input(start + i), out);
+    }
+    recorder.Tap();
+
+    size_t underruns = recorder.GetUnderruns();
+    TEST_ASSERT_TRUE(underruns > looperCacheChunks * looperChunkSize);
+
+    // Once Service() catches up the loop plays in full, without the overdub where it was missed
+    CheckPlayback(start, testCacheLoop, 2, true, true);
+    TEST_ASSERT_EQUAL(LOOP_PLAYING, recorder.GetState());
+    TEST_ASSERT_EQUAL_UINT32(underruns, recorder.GetUnderruns());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_storage_holds_max_length);
+    RUN_TEST(test_loop_points_inside_head);
+    RUN_TEST(test_loop_points_across_chunks);
+    RUN_TEST(test_loop_points_across_the_cache);
+    RUN_TEST(test_overdub_cost_and_content);
+    RUN_TEST(test_starved_recording_is_silent);
+    RUN_TEST(test_starved_overdub_keeps_the_recording);
+    return UNITY_END();
+}
@@ -0,0 +1,246 @@
+/**********************************************
+ * PitchTracker host accuracy tests, run with: pio test -e native
+ *
+ * The repository has no recorded guitar takes, so two synthetic sources stand in for them:
+ * a decaying harmonic series with a weak fundamental, and a Karplus-Strong string plucked
+ * with a noise burst, whose slightly detuned, decaying partials are closer to a real string.
+ **********************************************/
+
+#include <unity.h>
+#include <math.h>
+#include "../../lib/Analysis/PitchTracker.h"
+
+// Each note is played for this long, the estimate is read at the end
+static const size_t testNoteSamples = 28800;
+
+// Open strings of a guitar in standard tuning, then the 12th and 24th frets of the high E string
+static const float testNotes[] = {82.41f, 110.0f, 146.83f, 196.0f, 246.94f, 329.63f, 659.26f, 1318.51f};
+static const size_t testNoteCount = sizeof(testNotes) / sizeof(testNotes[0]);
+
+// Harmonic levels of the additive note, a weak fundamental is the hard case for autocorrelation methods
+static const float testHarmonics[] = {0.4f, 1.0f, 0.6f, 0.3f, 0.2f};
+static const size_t testHarmonicCount = sizeof(testHarmonics) / sizeof(testHarmonics[0]);
+
+// Largest pitch error accepted
+static const float testMaxCents = 5.0f;
+
+// Offset added to a note, bigger than the note once it has faded, like a codec or a saturation stage can leave
+static const float testDcOffset = 0.2f;
+
+// A note has to be published as voiced this soon after it starts
+static const size_t testMaxLatencySamples = (size_t)(0.15f * sampleRateHz);
+
+// Karplus-Strong string, the loop is long enough for the lowest note the tracker accepts
+static const size_t testStringBufferSize = 2048;
+static const float testStringDecaySeconds = 1.5f;
+
+static PitchTracker tracker;
+
+// Overruns of every note run so far in the test, Reset() clears the tracker's own count
+static size_t testOverruns;
+
+// Noise in -1 to 1 from a fixed seed, so every run sees the same signal
+static float NextNoise(uint32_t &state)
+{
+    state = (state * 1664525u) + 1013904223u;
+    return ((float)(state >> 8) * (2.0f / 16777216.0f)) - 1.0f;
+}
+
+// Plucked note with a decaying harmonic series, harmonics above the tracker's band are left out
+static float AdditiveNote(float freq, size_t sample)
+{
+    float t = (float)sample / sampleRateHz;
+    float out = 0.0f;
+    for (size_t h = 0; h < testHarmonicCount; h++)
+    {
+        float harmonicFreq = freq * (float)(h + 1);
+        if (harmonicFreq < 5000.0f)
+        {
+            out += testHarmonics[h] * sinf(2.0f * (float)PI_VAL * harmonicFreq * t);
+        }
+    }
+    return 0.3f * expf(-1.5f * t) * out;
+}
+
+/**
+ * Karplus-Strong string: a noise burst one period long circulates through a delay line and a two point average
+ */
+class TestString
+{
+public:
+    void Init(float freq, uint32_t seed)
+    {
+        // The average adds half a sample to the loop, the loss sets a 60dB decay time whatever the pitch
+        delay = (sampleRateHz / freq) - 0.5f;
+        loss = powf(10.0f, -3.0f / (testStringDecaySeconds * freq));
+        burstLength = (size_t)delay;
+        noiseState = seed;
+        writeIndex = 0;
+        sample = 0;
+        for (size_t i = 0; i < testStringBufferSize; i++)
+        {
+            buffer[i] = 0.0f;
+        }
+    }
+
+    float Process()
+    {
+        float excitation = (sample < burstLength) ? (0.3f * NextNoise(noiseState)) : 0.0f;
+        sample++;
+
+        float delayed = Read(delay);
+        float previous = Read(delay + 1.0f);
+        float out = excitation + (loss * 0.5f * (delayed + previous));
+
+        buffer[writeIndex] = out;
+        writeIndex = (writeIndex + 1) % testStringBufferSize;
+        return out;
+    }
+
+private:
+    // Linear interpolation between the two samples around the delay
+    float Read(float samples)
+    {
+        size_t whole = (size_t)samples;
+        float frac = samples - (float)whole;
+        size_t a = (writeIndex + testStringBufferSize - whole) % testStringBufferSize;
+        size_t b = (a + testStringBufferSize - 1) % testStringBufferSize;
+        return buffer[a] + ((buffer[b] - buffer[a]) * frac);
+    }
+
+    float buffer[testStringBufferSize];
+    float delay;
+    float loss;
+    size_t burstLength;
+    size_t writeIndex;
+    size_t sample;
+    uint32_t noiseState;
+};
+
+static TestString testString;
+
+// Feeds a signal for one note length and returns the last estimate
+template <typename Signal>
+static PitchEstimate RunSignal(Signal signal)
+{
+    tracker.Reset();
+    for (size_t i = 0; i < testNoteSamples; i++)
+    {
+        tracker.Process(signal(i));
+    }
+    testOverruns += tracker.GetOverruns();
+
+    PitchEstimate estimate;
+    tracker.Read(estimate);
+    return estimate;
+}
+
+static float Cents(float measured, float expected)
+{
+    return 1200.0f * log2f(measured / expected);
+}
+
+static void CheckVoiced(const PitchEstimate &estimate, float expected, float maxCents)
+{
+    TEST_ASSERT_TRUE(estimate.frequency > 0.0f);
+    TEST_ASSERT_TRUE(estimate.clarity >= pitchMinClarity);
+    TEST_ASSERT_FLOAT_WITHIN(maxCents, 0.0f, Cents(estimate.frequency, expected));
+}
+
+void setUp()
+{
+    tracker.Init(sampleRateHz);
+    testOverruns = 0;
+}
+
+void tearDown()
+{
+}
+
+void test_additive_notes_within_cents()
+{
+    for (size_t n = 0; n < testNoteCount; n++)
+    {
+        float freq = testNotes[n];
+        CheckVoiced(RunSignal([freq](size_t i) { return AdditiveNote(freq, i); }), freq, testMaxCents);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, testOverruns);
+}
+
+void test_plucked_strings_within_cents()
+{
+    for (size_t n = 0; n < testNoteCount; n++)
+    {
+        float freq = testNotes[n];
+        testString.Init(freq, (uint32_t)(n + 1));
+        CheckVoiced(RunSignal([](size_t) { return testString.Process(); }), freq, testMaxCents);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, testOverruns);
+}
+
+void test_dc_offset_does_not_hide_the_pitch()
+{
+    for (size_t n = 0; n < testNoteCount; n++)
+    {
+        float freq = testNotes[n];
+        CheckVoiced(RunSignal([freq](size_t i) { return AdditiveNote(freq, i) + testDcOffset; }), freq, testMaxCents);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, testOverruns);
+}
+
+void test_noise_is_unvoiced()
+{
+    uint32_t noiseState = 1;
+    PitchEstimate estimate = RunSignal([&noiseState](size_t) { return 0.1f * NextNoise(noiseState); });
+
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, estimate.frequency);
+    TEST_ASSERT_TRUE(estimate.count > 0);
+}
+
+void test_silence_is_unvoiced()
+{
+    PitchEstimate estimate = RunSignal([](size_t) { return 0.0f; });
+
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, estimate.frequency);
+    TEST_ASSERT_TRUE(estimate.count > 0);
+}
+
+void test_note_is_published_within_latency()
+{
+    const float freq = 196.0f;
+
+    // Silence first so the note starts partway through a hop
+    for (size_t i = 0; i < testNoteSamples / 3; i++)
+    {
+        tracker.Process(0.0f);
+    }
+
+    PitchEstimate estimate;
+    tracker.Read(estimate);
+    size_t latency = 0;
+    while (latency < testNoteSamples)
+    {
+        tracker.Process(AdditiveNote(freq, latency));
+        latency++;
+
+        if (tracker.Read(estimate) && estimate.frequency > 0.0f)
+        {
+            break;
+        }
+    }
+
+    TEST_ASSERT_TRUE(latency <= testMaxLatencySamples);
+    TEST_ASSERT_FLOAT_WITHIN(testMaxCents * 4.0f, 0.0f, Cents(estimate.frequency, freq));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_additive_notes_within_cents);
+    RUN_TEST(test_plucked_strings_within_cents);
+    RUN_TEST(test_dc_offset_does_not_hide_the_pitch);
+    RUN_TEST(test_noise_is_unvoiced);
+    RUN_TEST(test_silence_is_unvoiced);
+    RUN_TEST(test_note_is_published_within_latency);
+    return UNITY_END();
+}
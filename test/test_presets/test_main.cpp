@@ -0,0 +1,180 @@
+/**********************************************
+ * PresetStore host tests, run with: pio test -e native
+ *
+ * On the host each flash sector is a file in the working directory, so a power loss is
+ * modelled by leaving the files the way an interrupted save would, then opening a new store.
+ **********************************************/
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "../../lib/Presets/PresetStore.h"
+
+static const uint32_t testStoreAddress = presetFlashSize - presetStoreSize;
+static const uint8_t testPayloadVersion = 3;
+
+// Records per sector
+static const size_t testSlots = presetSectorSize / presetRecordSize;
+
+// Enough saves to go around both sectors a few times
+static const size_t testSaves = (testSlots * presetStoreSectors * 2) + 17;
+
+struct TestPayload
+{
+    uint32_t value;
+    uint8_t fill[12];
+};
+
+static TestPayload Payload(uint32_t value)
+{
+    TestPayload payload;
+    payload.value = value;
+    memset(payload.fill, (int)(value & 0xFF), sizeof(payload.fill));
+    return payload;
+}
+
+// File the host backend keeps a sector in
+static void SectorFile(size_t sector, char *name, size_t size)
+{
+    snprintf(name, size, "preset_%08lx.bin", (unsigned long)(testStoreAddress + (sector * presetSectorSize)));
+}
+
+static void RemoveSectors()
+{
+    for (size_t sector = 0; sector < presetStoreSectors; sector++)
+    {
+        char name[32];
+        SectorFile(sector, name, sizeof(name));
+        remove(name);
+    }
+}
+
+// Opens the store the way Setup does after a reset and returns the loaded value, or 0 if nothing loads
+static uint32_t Reboot(PresetStore &store)
+{
+    store.Init(testStoreAddress, testPayloadVersion);
+
+    TestPayload loaded = Payload(0);
+    if (!store.Load(&loaded, sizeof(loaded)))
+    {
+        return 0;
+    }
+    TEST_ASSERT_EQUAL(0, memcmp(loaded.fill, Payload(loaded.value).fill, sizeof(loaded.fill)));
+    return loaded.value;
+}
+
+void setUp()
+{
+    RemoveSectors();
+}
+
+void tearDown()
+{
+    RemoveSectors();
+}
+
+void test_empty_store_loads_nothing()
+{
+    PresetStore store;
+    TEST_ASSERT_EQUAL_UINT32(0, Reboot(store));
+}
+
+void test_every_save_survives_a_reset()
+{
+    PresetStore store;
+    Reboot(store);
+
+    for (uint32_t value = 1; value <= testSaves; value++)
+    {
+        TestPayload payload = Payload(value);
+        TEST_ASSERT_TRUE(store.Save(&payload, sizeof(payload)));
+
+        PresetStore restarted;
+        TEST_ASSERT_EQUAL_UINT32(value, Reboot(restarted));
+    }
+}
+
+// Saves values 1 to testSlots, which fills the first sector exactly
+static void FillFirstSector(PresetStore &store)
+{
+    Reboot(store);
+    for (uint32_t value = 1; value <= testSlots; value++)
+    {
+        TestPayload payload = Payload(value);
+        TEST_ASSERT_TRUE(store.Save(&payload, sizeof(payload)));
+    }
+}
+
+void test_failed_write_at_sector_switch_keeps_full_sector()
+{
+    PresetStore store;
+    FillFirstSector(store);
+
+    // A directory in place of the spare sector's file makes the write fail
+    char name[32];
+    SectorFile(1, name, sizeof(name));
+    TEST_ASSERT_EQUAL(0, mkdir(name, 0700));
+
+    TestPayload payload = Payload(1000);
+    TEST_ASSERT_FALSE(store.Save(&payload, sizeof(payload)));
+    remove(name);
+
+    PresetStore restarted;
+    TEST_ASSERT_EQUAL_UINT32(testSlots, Reboot(restarted));
+}
+
+void test_torn_write_at_sector_switch_keeps_full_sector()
+{
+    PresetStore store;
+    FillFirstSector(store);
+
+    // Power is lost part way through the first record of the spare sector, the full one is not erased yet
+    uint8_t torn[presetRecordSize / 2];
+    memset(torn, 0, sizeof(torn));
+    torn[0] = 'P';
+    torn[1] = 'R';
+    char name[32];
+    SectorFile(1, name, sizeof(name));
+    FILE *file = fopen(name, "wb");
+    TEST_ASSERT_TRUE(file != nullptr);
+    fwrite(torn, 1, sizeof(torn), file);
+    fclose(file);
+
+    PresetStore restarted;
+    TEST_ASSERT_EQUAL_UINT32(testSlots, Reboot(restarted));
+
+    // The next save erases the spare sector before using it, then retires the full one
+    TestPayload payload = Payload(1000);
+    TEST_ASSERT_TRUE(restarted.Save(&payload, sizeof(payload)));
+
+    PresetStore again;
+    TEST_ASSERT_EQUAL_UINT32(1000, Reboot(again));
+    SectorFile(0, name, sizeof(name));
+    file = fopen(name, "rb");
+    TEST_ASSERT_TRUE(file == nullptr);
+}
+
+void test_other_payload_version_is_ignored()
+{
+    PresetStore store;
+    Reboot(store);
+    TestPayload payload = Payload(42);
+    TEST_ASSERT_TRUE(store.Save(&payload, sizeof(payload)));
+
+    PresetStore newer;
+    newer.Init(testStoreAddress, testPayloadVersion + 1);
+    TestPayload loaded = Payload(0);
+    TEST_ASSERT_FALSE(newer.Load(&loaded, sizeof(loaded)));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_store_loads_nothing);
+    RUN_TEST(test_every_save_survives_a_reset);
+    RUN_TEST(test_failed_write_at_sector_switch_keeps_full_sector);
+    RUN_TEST(test_torn_write_at_sector_switch_keeps_full_sector);
+    RUN_TEST(test_other_payload_version_is_ignored);
+    return UNITY_END();
+}